@@ -0,0 +1,46 @@
+#include <pebble.h>
+#include "blit.h"
+
+/*
+The code in this file implements the frame buffer pixel routines that
+are not inline.
+*/
+
+//Four glyph bits to four byte masks; bit 0 is the pixel at the lowest
+//address, which is the low byte of a little-endian word
+const uint32_t blit_nibble_masks[16] =
+{
+  0x00000000, 0x000000FF, 0x0000FF00, 0x0000FFFF,
+  0x00FF0000, 0x00FF00FF, 0x00FFFF00, 0x00FFFFFF,
+  0xFF000000, 0xFF0000FF, 0xFF00FF00, 0xFF00FFFF,
+  0xFFFF0000, 0xFFFF00FF, 0xFFFFFF00, 0xFFFFFFFF,
+};
+
+/*
+blit_fill_span_8bit takes 4 arguments: the start of an 8-bit row, the
+  first x to fill, how many pixels to fill and the GColor8 value
+Function fills the span a byte at a time up to a word boundary, then a
+  32-bit word (four pixels) at a time, then finishes the tail by bytes
+*/
+void blit_fill_span_8bit(uint8_t *row, int x, int width, uint8_t color)
+{
+  uint8_t *pixel = row + x;
+  uint8_t *end = pixel + width;
+  
+  while(pixel < end && ((uintptr_t)pixel & 3))
+  {
+    *pixel++ = color;
+  }
+  
+  uint32_t word = color * 0x01010101u;
+  while(end - pixel >= 4)
+  {
+    *(uint32_t *)pixel = word;
+    pixel += 4;
+  }
+  
+  while(pixel < end)
+  {
+    *pixel++ = color;
+  }
+}
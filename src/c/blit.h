@@ -0,0 +1,135 @@
+#pragma once
+#include <pebble.h>
+
+/*
+Word-at-a-time pixel routines for drawing straight into a captured frame
+buffer (see graphics_capture_frame_buffer). They do no clipping; callers
+pass spans and glyphs that are inside the frame buffer.
+
+Glyphs come from pre-rasterized 1-bit strips: each glyph row is at most
+32 pixels, starts on a byte boundary and has its leftmost pixel in bit 0
+(Pebble's 1-bit order). The glyph blitters are inline so that a call
+with a constant width is unrolled for that width.
+*/
+
+//Byte masks for four 8-bit pixels, indexed by four glyph bits
+extern const uint32_t blit_nibble_masks[16];
+
+void blit_fill_span_8bit(uint8_t *row, int x, int width, uint8_t color);
+
+/*
+blit_load_row takes 2 arguments: a glyph row and its width in pixels
+Function returns the row's pixels as bits, leftmost in bit 0
+*/
+static inline __attribute__((always_inline))
+uint32_t blit_load_row(const uint8_t *src, int width)
+{
+  uint32_t bits = src[0];
+  if(width > 8)
+  {
+    bits |= (uint32_t)src[1] << 8;
+  }
+  if(width > 16)
+  {
+    bits |= (uint32_t)src[2] << 16;
+  }
+  if(width > 24)
+  {
+    bits |= (uint32_t)src[3] << 24;
+  }
+  return width >= 32 ? bits : bits & ((1u << width) - 1);
+}
+
+/*
+blit_glyph_8bit takes 8 arguments: the 8-bit frame buffer row the glyph's
+  top is drawn on, the frame buffer's bytes per row, x, the glyph's
+  first row, the strip's bytes per row, the glyph's width and height,
+  and the GColor8 value to draw set pixels in
+Function draws the glyph's set pixels byte-wise until x is word
+  aligned, then four pixels per masked 32-bit store
+*/
+static inline __attribute__((always_inline))
+void blit_glyph_8bit(uint8_t *dst, int dst_stride, int x, const uint8_t *src,
+                     int src_stride, int width, int height, uint8_t color)
+{
+  uint32_t color_word = color * 0x01010101u;
+  for(int y = 0; y < height; y++)
+  {
+    uint32_t bits = blit_load_row(src + y * src_stride, width);
+    uint8_t *pixel = dst + y * dst_stride + x;
+    int remaining = width;
+    
+    while(remaining > 0 && ((uintptr_t)pixel & 3))
+    {
+      if(bits & 1)
+      {
+        *pixel = color;
+      }
+      bits >>= 1;
+      pixel++;
+      remaining--;
+    }
+    while(remaining >= 4)
+    {
+      uint32_t mask = blit_nibble_masks[bits & 0xF];
+      if(mask)
+      {
+        uint32_t *word = (uint32_t *)pixel;
+        *word = (*word & ~mask) | (color_word & mask);
+      }
+      bits >>= 4;
+      pixel += 4;
+      remaining -= 4;
+    }
+    while(remaining > 0)
+    {
+      if(bits & 1)
+      {
+        *pixel = color;
+      }
+      bits >>= 1;
+      pixel++;
+      remaining--;
+    }
+  }
+}
+
+/*
+blit_glyph_1bit takes 8 arguments: the 1-bit frame buffer row the glyph's
+  top is drawn on, the frame buffer's bytes per row (a multiple of 4),
+  x, the glyph's first row, the strip's bytes per row, the glyph's width
+  and height, and whether to draw set pixels white (true) or black
+  (false)
+Function shifts each glyph row to x's bit position and merges it into
+  the one or two aligned 32-bit words of the frame buffer it covers
+*/
+static inline __attribute__((always_inline))
+void blit_glyph_1bit(uint8_t *dst, int dst_stride, int x, const uint8_t *src,
+                     int src_stride, int width, int height, bool white)
+{
+  int shift = x & 31;
+  bool spills = shift + width > 32;
+  for(int y = 0; y < height; y++)
+  {
+    uint32_t bits = blit_load_row(src + y * src_stride, width);
+    uint32_t *word = (uint32_t *)(dst + y * dst_stride) + (x >> 5);
+    uint32_t low = bits << shift;
+    uint32_t high = spills ? bits >> (32 - shift) : 0;
+    if(white)
+    {
+      word[0] |= low;
+      if(spills)
+      {
+        word[1] |= high;
+      }
+    }
+    else
+    {
+      word[0] &= ~low;
+      if(spills)
+      {
+        word[1] &= ~high;
+      }
+    }
+  }
+}
@@ -0,0 +1,116 @@
+#include <pebble.h>
+#include "event_log.h"
+
+/*
+The code in this file keeps the event log ring buffer and sends it to the
+phone in chunks when asked to.
+*/
+
+#if EVENT_LOG_LEVEL > EVENT_LOG_LEVEL_NONE
+
+//Ring buffer size, and how many records fit in one 128-byte outbox message
+#define EVENT_LOG_CAPACITY 32
+#define EVENT_LOG_RECORDS_PER_MESSAGE 12
+
+static EventLogRecord s_records[EVENT_LOG_CAPACITY];
+//Index the next record is written to, how many records are stored, and
+//how many have ever been written (a record's sequence number)
+static int s_next, s_count;
+static uint32_t s_written;
+//Sequence numbers of the next record the current dump sends and of the
+//first record written after it started, which it stops before
+static bool s_dumping;
+static uint32_t s_dump_next, s_dump_end;
+
+/*
+event_log_record takes 2 arguments: what happened and a code-specific
+  reason (usually an AppMessageResult)
+Function stores the event with the current time, overwriting the oldest
+  record once the ring is full
+*/
+void event_log_record(EventCode code, uint16_t reason)
+{
+  EventLogRecord *record = &s_records[s_next];
+  record->timestamp = (uint32_t)time(NULL);
+  record->reason = reason;
+  record->code = (uint8_t)code;
+  record->unused = 0;
+  
+  s_next = (s_next + 1) % EVENT_LOG_CAPACITY;
+  s_written++;
+  if(s_count < EVENT_LOG_CAPACITY)
+  {
+    s_count++;
+  }
+}
+
+/*
+event_log_dump_continue takes no arguments
+Function sends the next chunk of records (oldest first) if a dump is in
+  progress. It is called from the outbox sent callback so each chunk
+  goes out once the previous one has been delivered. Records written
+  since the dump started are left for the next dump, and records the
+  ring overwrote before they were sent are skipped, so none is sent twice
+*/
+void event_log_dump_continue(void)
+{
+  if(!s_dumping)
+  {
+    return;
+  }
+  
+  //Skip anything overwritten since the dump started
+  uint32_t oldest = s_written - s_count;
+  if((int32_t)(s_dump_next - oldest) < 0)
+  {
+    s_dump_next = oldest;
+  }
+  if((int32_t)(s_dump_end - s_dump_next) <= 0)
+  {
+    s_dumping = false;
+    return;
+  }
+  
+  //Copy the chunk out of the ring so it is contiguous
+  EventLogRecord chunk[EVENT_LOG_RECORDS_PER_MESSAGE];
+  int count = MIN(EVENT_LOG_RECORDS_PER_MESSAGE, (int)(s_dump_end - s_dump_next));
+  for(int i = 0; i < count; i++)
+  {
+    chunk[i] = s_records[(s_dump_next + i) % EVENT_LOG_CAPACITY];
+  }
+  
+  DictionaryIterator *iter;
+  if(app_message_outbox_begin(&iter) != APP_MSG_OK)
+  {
+    //The outbox is busy; give up rather than spin, the phone can ask again
+    s_dumping = false;
+    return;
+  }
+  dict_write_data(iter, MESSAGE_KEY_LOG_RECORDS, (const uint8_t *)chunk, count * sizeof(EventLogRecord));
+  app_message_outbox_send();
+  s_dump_next += count;
+}
+
+/*
+event_log_dump_start takes no arguments
+Function begins sending the records in the ring buffer to the phone
+*/
+void event_log_dump_start(void)
+{
+  s_dumping = true;
+  s_dump_next = s_written - s_count;
+  s_dump_end = s_written;
+  event_log_dump_continue();
+}
+
+/*
+event_log_dump_cancel takes no arguments
+Function ends the dump in progress, for when a chunk failed to send, so
+  that a later unrelated outbox sent callback does not resume it
+*/
+void event_log_dump_cancel(void)
+{
+  s_dumping = false;
+}
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+#include <pebble.h>
+
+/*
+The event log replaces free-text APP_LOG calls with small binary records
+kept in a RAM ring buffer, so diagnostics cost no radio time until the
+phone asks for them (see event_log_dump_start).
+
+EVENT_LOG_LEVEL selects what is compiled in:
+  EVENT_LOG_LEVEL_NONE  - nothing, every macro below generates no code
+  EVENT_LOG_LEVEL_ERROR - LOG_ERROR records only
+  EVENT_LOG_LEVEL_INFO  - LOG_ERROR and LOG_INFO records (default)
+  EVENT_LOG_LEVEL_DEBUG - records plus LOG_DEBUG text through APP_LOG
+*/
+#define EVENT_LOG_LEVEL_NONE 0
+#define EVENT_LOG_LEVEL_ERROR 1
+#define EVENT_LOG_LEVEL_INFO 2
+#define EVENT_LOG_LEVEL_DEBUG 3
+
+#ifndef EVENT_LOG_LEVEL
+#define EVENT_LOG_LEVEL EVENT_LOG_LEVEL_INFO
+#endif
+
+//What happened; sent to the phone as the record's code byte
+typedef enum
+{
+  EVENT_INBOX_DROPPED = 1,
+  EVENT_OUTBOX_FAILED = 2,
+  EVENT_BT_BLIP_DEBOUNCED = 3,
+  EVENT_BT_VIBE_LIMITED = 4,
+} EventCode;
+
+//One ring buffer entry, 8 bytes, sent to the phone as-is (little endian)
+typedef struct
+{
+  uint32_t timestamp;
+  uint16_t reason;
+  uint8_t code;
+  uint8_t unused;
+} EventLogRecord;
+
+#if EVENT_LOG_LEVEL > EVENT_LOG_LEVEL_NONE
+void event_log_record(EventCode code, uint16_t reason);
+void event_log_dump_start(void);
+void event_log_dump_continue(void);
+void event_log_dump_cancel(void);
+#else
+static inline void event_log_dump_start(void) {}
+static inline void event_log_dump_continue(void) {}
+static inline void event_log_dump_cancel(void) {}
+#endif
+
+#if EVENT_LOG_LEVEL >= EVENT_LOG_LEVEL_ERROR
+#define LOG_ERROR(code, reason) event_log_record((code), (uint16_t)(reason))
+#else
+#define LOG_ERROR(code, reason) ((void)0)
+#endif
+
+#if EVENT_LOG_LEVEL >= EVENT_LOG_LEVEL_INFO
+#define LOG_INFO(code, reason) event_log_record((code), (uint16_t)(reason))
+#else
+#define LOG_INFO(code, reason) ((void)0)
+#endif
+
+//The disabled form still type-checks its arguments so values that are
+//only logged do not trip unused-variable warnings, then compiles away
+#if EVENT_LOG_LEVEL >= EVENT_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) APP_LOG(APP_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do { if(0) { APP_LOG(APP_LOG_LEVEL_DEBUG, __VA_ARGS__); } } while(0)
+#endif
@@ -0,0 +1,103 @@
+#include <pebble.h>
+#include "fmt.h"
+
+/*
+The code in this file implements the FmtWriter formatting functions.
+*/
+
+/*
+fmt_char takes 2 arguments: the writer and a character
+Function appends the character if there is room for it and the NUL
+*/
+static void fmt_char(FmtWriter *writer, char c)
+{
+  if(writer->length + 1 < writer->size)
+  {
+    writer->buffer[writer->length++] = c;
+    writer->buffer[writer->length] = '\0';
+  }
+}
+
+/*
+fmt_begin takes 3 arguments: the writer, the buffer and its size
+Function starts the writer on an empty buffer
+*/
+void fmt_begin(FmtWriter *writer, char *buffer, size_t size)
+{
+  writer->buffer = buffer;
+  writer->size = size;
+  writer->length = 0;
+  if(size > 0)
+  {
+    buffer[0] = '\0';
+  }
+}
+
+/*
+fmt_str takes 2 arguments: the writer and a string
+Function appends as much of the string as fits
+*/
+void fmt_str(FmtWriter *writer, const char *text)
+{
+  while(*text && writer->length + 1 < writer->size)
+  {
+    writer->buffer[writer->length++] = *text++;
+  }
+  if(writer->size > 0)
+  {
+    writer->buffer[writer->length] = '\0';
+  }
+}
+
+/*
+fmt_uint takes 2 arguments: the writer and a value
+Function appends the value in decimal
+*/
+void fmt_uint(FmtWriter *writer, unsigned int value)
+{
+  //Digits come out lowest first, so build them backwards
+  char digits[10];
+  int count = 0;
+  do
+  {
+    digits[count++] = (char)('0' + value % 10);
+    value /= 10;
+  } while(value);
+  
+  while(count)
+  {
+    fmt_char(writer, digits[--count]);
+  }
+}
+
+/*
+fmt_int_unit takes 3 arguments: the writer, a signed value and a unit
+  suffix (e.g. "F")
+Function appends the value in decimal followed by the unit
+*/
+void fmt_int_unit(FmtWriter *writer, int value, const char *unit)
+{
+  if(value < 0)
+  {
+    fmt_char(writer, '-');
+    //Negate as unsigned so INT_MIN does not overflow
+    fmt_uint(writer, 0u - (unsigned int)value);
+  }
+  else
+  {
+    fmt_uint(writer, (unsigned int)value);
+  }
+  fmt_str(writer, unit);
+}
+
+/*
+fmt_copy takes 3 arguments: the destination buffer, a string and the
+  buffer's size
+Function copies as much of the string as fits, always NUL-terminated
+*/
+void fmt_copy(char *buffer, const char *text, size_t size)
+{
+  FmtWriter writer;
+  fmt_begin(&writer, buffer, size);
+  fmt_str(&writer, text);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <pebble.h>
+
+/*
+A small allocation-free formatter used instead of snprintf. A FmtWriter
+appends to a fixed buffer, truncates instead of overflowing and keeps
+the buffer NUL-terminated after every call.
+*/
+typedef struct
+{
+  char *buffer;
+  size_t size;
+  size_t length;
+} FmtWriter;
+
+void fmt_begin(FmtWriter *writer, char *buffer, size_t size);
+void fmt_str(FmtWriter *writer, const char *text);
+void fmt_uint(FmtWriter *writer, unsigned int value);
+void fmt_int_unit(FmtWriter *writer, int value, const char *unit);
+void fmt_copy(char *buffer, const char *text, size_t size);
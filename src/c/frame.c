@@ -0,0 +1,88 @@
+#include <pebble.h>
+#include "frame.h"
+#include "scheduler.h"
+#include "event_log.h"
+
+/*
+The code in this file keeps the pending FrameDirty bits and schedules
+the single commit that applies them.
+*/
+
+static FrameCommitHandler s_handler;
+static SchedulerTask *s_commit_task;
+static uint32_t s_pending;
+//Requests that joined a frame which was already pending
+static int s_coalesced;
+
+/*
+frame_commit takes 1 argument: the task context (unused)
+Function hands every collected request to the commit handler at once
+*/
+static void frame_commit(void *context)
+{
+  uint32_t dirty = s_pending;
+  s_commit_task = NULL;
+  s_pending = 0;
+  
+  s_handler(dirty);
+  LOG_DEBUG("Frame committed (0x%x), %d requests coalesced so far", (unsigned int)dirty, s_coalesced);
+}
+
+/*
+frame_init takes 1 argument: the function that applies a commit
+Function sets up the frame scheduler
+*/
+void frame_init(FrameCommitHandler handler)
+{
+  s_handler = handler;
+}
+
+/*
+frame_request takes 1 argument: the FrameDirty bits to redraw
+Function adds the bits to the next frame, scheduling it if this is the
+  first request since the last commit. Later requests join the pending
+  task rather than scheduling one of their own, so however many services
+  fire before the commit they share its single wakeup
+*/
+void frame_request(uint32_t dirty)
+{
+  if(s_pending)
+  {
+    s_coalesced++;
+  }
+  s_pending |= dirty;
+  
+  if(!s_commit_task)
+  {
+    s_commit_task = scheduler_add(0, FRAME_COMMIT_TOLERANCE_MS, frame_commit, NULL);
+    if(!s_commit_task)
+    {
+      //No room to defer it, so commit straight away
+      frame_commit(NULL);
+    }
+  }
+}
+
+/*
+frame_cancel takes no arguments
+Function drops any pending frame, for when the layers go away
+*/
+void frame_cancel(void)
+{
+  if(s_commit_task)
+  {
+    scheduler_cancel(s_commit_task);
+    s_commit_task = NULL;
+  }
+  s_pending = 0;
+}
+
+/*
+frame_coalesced_count takes no arguments
+Function returns how many requests were merged into an already pending
+  frame since launch
+*/
+int frame_coalesced_count(void)
+{
+  return s_coalesced;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <pebble.h>
+
+/*
+The frame scheduler collects the parts of the face that services want
+redrawn and commits them together, so several services firing close
+together (a reconnect, weather arriving and a tick) cost one render
+instead of one each.
+*/
+
+//Commits are held back at most this long to collect more requests
+#define FRAME_COMMIT_TOLERANCE_MS 50
+
+//Parts of the face a service can ask to have redrawn
+typedef enum
+{
+  FRAME_TIME = 1 << 0,
+  FRAME_WEATHER = 1 << 1,
+  FRAME_BATTERY = 1 << 2,
+  FRAME_BLUETOOTH = 1 << 3,
+  FRAME_THEME = 1 << 4,
+} FrameDirty;
+
+//Applies the collected FrameDirty bits to the layers in one pass
+typedef void (*FrameCommitHandler)(uint32_t dirty);
+
+void frame_init(FrameCommitHandler handler);
+void frame_request(uint32_t dirty);
+void frame_cancel(void);
+int frame_coalesced_count(void);
@@ -1,4 +1,15 @@
 #include <pebble.h>
+#include "event_log.h"
+#include "telemetry.h"
+#include "scheduler.h"
+#include "frame.h"
+#include "fmt.h"
+#include "blit.h"
+#include "mono_text.h"
+#include "stream_bitmap.h"
+#include "tiled_bitmap.h"
+#include "theme.h"
+#include "vector_icon.h"
 
 /*
 Code written by Jordan Donaldson using the Pebble SDK, C, and JavaScript. Code written using
@@ -11,68 +22,378 @@ The code in this file handles the time, date, printing of weather, and battery l
 //Pointers
 //Main window
 static Window *s_main_window;
+//Set MONOSPACE_TEXT to 1 to draw the date and weather lines with the
+//monospace glyph renderer (see mono_text.h) instead of TextLayers
+#ifndef MONOSPACE_TEXT
+#define MONOSPACE_TEXT 0
+#endif
+
 //Text layers
-static TextLayer *s_date_layer, *s_time_layer;
-static TextLayer *s_weather_layer;
-//Fonts
-static GFont s_time_font, s_date_font;
-static GFont s_weather_font;
+static TextLayer *s_time_layer;
+#if MONOSPACE_TEXT
+static Layer *s_date_layer, *s_weather_layer;
+#else
+static TextLayer *s_date_layer, *s_weather_layer;
+#endif
+//Fonts (the date and weather lines share the 18px font)
+static GFont s_time_font;
+#if MONOSPACE_TEXT
+static MonoFont *s_small_font;
+#else
+static GFont s_small_font;
+#endif
+//Set STREAM_BACKGROUND to 1 to draw the background straight from its
+//resource each frame (see stream_bitmap.h) instead of keeping the decoded
+//bitmap in the heap
+#ifndef STREAM_BACKGROUND
+#define STREAM_BACKGROUND 0
+#endif
+//Set TILED_BACKGROUND to 1 to draw the background from deduplicated tiles
+//(see tiled_bitmap.h) instead of one bitmap
+#ifndef TILED_BACKGROUND
+#define TILED_BACKGROUND 0
+#endif
+#if STREAM_BACKGROUND && TILED_BACKGROUND
+#error "STREAM_BACKGROUND and TILED_BACKGROUND are alternatives"
+#endif
+
+//Set VECTOR_ICONS to 1 to draw the BT icon from its Pebble Draw Command
+//resource, scaled to the screen (see vector_icon.h), instead of the PNG.
+//Both resources are packed either way; package.json cannot depend on it
+#ifndef VECTOR_ICONS
+#define VECTOR_ICONS 0
+#endif
+
 //Images
-static BitmapLayer *s_background_layer, *s_bt_icon_layer;
-static GBitmap *s_background_bitmap, *s_bt_icon_bitmap;
+#if VECTOR_ICONS
+static Layer *s_bt_icon_layer;
+static GDrawCommandImage *s_bt_icon_image;
+#define BT_ICON_LAYER() (s_bt_icon_layer)
+#define BT_ICON_LOADED() (s_bt_icon_image != NULL)
+#else
+static BitmapLayer *s_bt_icon_layer;
+static GBitmap *s_bt_icon_bitmap;
+#define BT_ICON_LAYER() bitmap_layer_get_layer(s_bt_icon_layer)
+#define BT_ICON_LOADED() (s_bt_icon_bitmap != NULL)
+#endif
+static GBitmap *s_background_bitmap;
+#if STREAM_BACKGROUND
+static StreamBitmap *s_background_stream;
+//Time spent streaming the background and redraws since the last minute
+//tick, which logs them as one telemetry record instead of one per frame
+static uint32_t s_stream_ms, s_stream_redraws;
+#elif TILED_BACKGROUND
+static TiledBitmap *s_background_tiles;
+#endif
+//Weather icon: one sprite sheet holding every condition's icon, and one
+//sub-bitmap of it that is moved onto the current condition's sprite
+#define WEATHER_ICON_SIZE 16
+static BitmapLayer *s_weather_icon_layer;
+static GBitmap *s_weather_sprites, *s_weather_icon;
+//Palettes the background, BT icon and weather sprites are recolored with
+//(see theme.h)
+static ThemePalette s_background_palette, s_bt_icon_palette, s_weather_sprites_palette;
+//Static scene (date bar and background)
+static Layer *s_background_layer;
+static void static_scene_invalidate();
+//Task that frees the BT icon bitmap a while after reconnecting
+static SchedulerTask *s_bt_icon_release_task;
 //Other pointers
-static int s_battery_level;
 static Layer *s_battery_layer;
 
+//Where the black bar behind the date is drawn
+#define DATE_BAR_RECT(bounds) GRect(0, 20, (bounds).size.w, 50)
+//Where the weather icon and the weather line are drawn; the line starts
+//right of the icon (and is inset as much on the right on round screens,
+//to stay centered) so the two never overlap
+#define WEATHER_ICON_X PBL_IF_ROUND_ELSE(20,2)
+#define WEATHER_ICON_RECT GRect(WEATHER_ICON_X, PBL_IF_ROUND_ELSE(127,122), \
+                                WEATHER_ICON_SIZE, WEATHER_ICON_SIZE)
+#define WEATHER_TEXT_INSET (WEATHER_ICON_X + WEATHER_ICON_SIZE + 2)
+#define WEATHER_TEXT_RECT(bounds) GRect(WEATHER_TEXT_INSET, PBL_IF_ROUND_ELSE(125,120), \
+  (bounds).size.w - WEATHER_TEXT_INSET - PBL_IF_ROUND_ELSE(WEATHER_TEXT_INSET,0), 25)
+
+//Set FAST_BATTERY_BAR to 0 to draw the battery bar with graphics_fill_rect
+//instead of writing it straight into the frame buffer
+#ifndef FAST_BATTERY_BAR
+#define FAST_BATTERY_BAR 1
+#endif
+
+//Persist key and layout version of the saved FaceState
+#define SNAPSHOT_KEY 1
+#define SNAPSHOT_VERSION 3
+
+/*
+FaceState holds everything the face renders. It is saved on exit and
+  restored on launch (see snapshot_save and snapshot_restore) so the
+  first frame is already complete; bump SNAPSHOT_VERSION whenever the
+  layout changes so old snapshots are ignored
+*/
+typedef struct
+{
+  uint8_t version;
+  bool connected;
+  int8_t battery_level;
+  bool has_weather;
+  uint8_t theme;
+  int16_t temperature;
+  int16_t weather_code;
+  uint32_t weather_time;
+  char conditions[24];
+  char time_text[8];
+  char date_text[16];
+  char weather_text[32];
+} FaceState;
+static FaceState s_state = { .connected = true, .battery_level = -1 };
+
+//The theme the face is drawn in, from s_state.theme
+#define FACE_THEME() theme_get(s_state.theme)
+
+//Startup state: when main() started, whether the first frame has been
+//drawn, and whether the deferred startup stages have all run
+static uint32_t s_launch_ms;
+static bool s_first_frame_drawn;
+static bool s_startup_complete;
+static void startup_stage_resources(void *context);
+
+//How long the BT icon bitmap is kept after a reconnect, so a flapping
+//connection does not reload it from resources every time
+#define BT_ICON_RELEASE_DELAY_MS 30000
+
+//Bluetooth alert tuning: a disconnect has to last BT_DEBOUNCE_MS before
+//the icon shows, and at most BT_VIBE_LIMIT vibrations are issued in any
+//BT_VIBE_WINDOW_S seconds
+#define BT_DEBOUNCE_MS 5000
+#define BT_DEBOUNCE_TOLERANCE_MS 1000
+#define BT_VIBE_LIMIT 3
+#define BT_VIBE_WINDOW_S 3600
+
+//Bluetooth debounce state
+static SchedulerTask *s_bt_debounce_task;
+static time_t s_bt_vibe_times[BT_VIBE_LIMIT];
+static int s_bt_vibe_index;
+//Counters of connection events that were absorbed
+static int s_bt_suppressed_disconnects, s_bt_suppressed_vibes;
+
+/*
+format_time takes 1 argument: the time to display
+Prints this time into the face state based on whether the clock is
+  24hour style or not
+Prints the date into the face state in day/mon/## order
+*/
+static void format_time(struct tm *tick_time)
+{
+  //Write the current hours and minutes into the face state
+  strftime(s_state.time_text, sizeof(s_state.time_text), clock_is_24h_style() ?
+           "%H:%M" : "%I:%M", tick_time);
+  
+  //Write the date into the face state
+  strftime(s_state.date_text, sizeof(s_state.date_text), "%a %b %e", tick_time);
+}
+
+/*
+update_time takes 1 argument: the time to display
+Function formats the time and date and asks for them to be redrawn
+*/
+static void update_time(struct tm *tick_time)
+{
+  format_time(tick_time);
+  frame_request(FRAME_TIME);
+}
+
 /*
-update_time takes no arguments
-Creates structure to hold local time and prints this time
-  based on whether the clock is 24hour style or not
-Creates array to hold date and prints this date
-  in day/mon/## order
+update_time_now takes no arguments
+Function reads the clock and formats the local time. This is only needed
+  for the first paint, before the window is loaded; every tick after
+  that passes its own time in
 */
-static void update_time()
+static void update_time_now()
 {
   //Get a tm structure
   time_t temp = time(NULL);
-  struct tm *tick_time = localtime(&temp);
-  //Write the current hours and minutes into a buffer
-  static char s_buffer[8];
-  strftime(s_buffer, sizeof(s_buffer), clock_is_24h_style() ?
-           "%H:%M" : "%I:%M", tick_time);
-  //Display this time on the TextLayer
-  text_layer_set_text(s_time_layer, s_buffer);
+  format_time(localtime(&temp));
+}
+
+/*
+weather_icon_index takes 1 argument: an OpenWeatherMap condition code
+Function returns the condition's sprite in the weather sprite sheet (in
+  the order of tools/sprites.py), or -1 if it has none
+*/
+static int weather_icon_index(int code)
+{
+  if(code >= 200 && code < 300)
+  {
+    return 4; //Thunderstorm
+  }
+  if(code >= 300 && code < 600)
+  {
+    return 2; //Drizzle and rain
+  }
+  if(code >= 600 && code < 700)
+  {
+    return 3; //Snow
+  }
+  if(code >= 700 && code < 800)
+  {
+    return 5; //Mist, fog, haze and dust
+  }
+  if(code == 800)
+  {
+    return 0; //Clear
+  }
+  if(code > 800 && code < 900)
+  {
+    return 1; //Clouds
+  }
+  return -1;
+}
+
+/*
+weather_icon_update takes no arguments
+Function points the weather icon at the current condition's sprite by
+  moving its bounds within the sprite sheet, and hides it when there is
+  no icon to show
+*/
+static void weather_icon_update()
+{
+  int index = s_state.has_weather ? weather_icon_index(s_state.weather_code) : -1;
+  if(index >= 0 && s_weather_icon)
+  {
+    gbitmap_set_bounds(s_weather_icon, GRect(index * WEATHER_ICON_SIZE, 0,
+                                             WEATHER_ICON_SIZE, WEATHER_ICON_SIZE));
+    layer_mark_dirty(bitmap_layer_get_layer(s_weather_icon_layer));
+  }
+  layer_set_hidden(bitmap_layer_get_layer(s_weather_icon_layer), index < 0 || !s_weather_icon);
+}
+
+/*
+theme_commit takes no arguments
+Function redraws the whole face in the current theme: the window and text
+  colors are set again, the loaded bitmaps' palettes are recolored in
+  place and the static scene is marked dirty so it is drawn again
+*/
+static void theme_commit()
+{
+  const Theme *theme = FACE_THEME();
+  window_set_background_color(s_main_window, theme->paper);
+  
+  text_layer_set_text_color(s_time_layer, theme->paper);
+#if MONOSPACE_TEXT
+  layer_mark_dirty(s_date_layer);
+  layer_mark_dirty(s_weather_layer);
+#else
+  text_layer_set_text_color(s_date_layer, theme->ink);
+  text_layer_set_text_color(s_weather_layer, theme->ink);
+#endif
   
-  //Create a date buffer
-  static char date_buffer[16];
-  strftime(date_buffer, sizeof(date_buffer), "%a %b %e", tick_time);
-  text_layer_set_text(s_date_layer, date_buffer);
+  if(s_background_bitmap)
+  {
+    theme_palette_update(&s_background_palette, theme);
+  }
+#if VECTOR_ICONS
+  if(s_bt_icon_image)
+  {
+    vector_icon_set_color(s_bt_icon_image, theme->ink);
+    layer_mark_dirty(BT_ICON_LAYER());
+  }
+#else
+  if(s_bt_icon_bitmap)
+  {
+    theme_palette_update(&s_bt_icon_palette, theme);
+    layer_mark_dirty(BT_ICON_LAYER());
+  }
+#endif
+  if(s_weather_sprites)
+  {
+    theme_palette_update(&s_weather_sprites_palette, theme);
+    layer_mark_dirty(bitmap_layer_get_layer(s_weather_icon_layer));
+  }
+  
+  static_scene_invalidate();
+  layer_mark_dirty(s_battery_layer);
+}
+
+/*
+frame_commit_layers takes 1 argument: the FrameDirty bits to redraw
+Function pushes the face state into the layers that need it, so all of
+  them are marked dirty together and drawn in one frame
+*/
+static void frame_commit_layers(uint32_t dirty)
+{
+  if(dirty & FRAME_TIME)
+  {
+    text_layer_set_text(s_time_layer, s_state.time_text);
+#if MONOSPACE_TEXT
+    layer_mark_dirty(s_date_layer);
+#else
+    text_layer_set_text(s_date_layer, s_state.date_text);
+#endif
+  }
+  if(dirty & FRAME_WEATHER)
+  {
+#if MONOSPACE_TEXT
+    layer_mark_dirty(s_weather_layer);
+#else
+    text_layer_set_text(s_weather_layer, s_state.weather_text);
+#endif
+    weather_icon_update();
+  }
+  if(dirty & FRAME_BATTERY)
+  {
+    layer_mark_dirty(s_battery_layer);
+  }
+  if(dirty & FRAME_BLUETOOTH)
+  {
+    layer_set_hidden(BT_ICON_LAYER(), s_state.connected);
+  }
+  if(dirty & FRAME_THEME)
+  {
+    theme_commit();
+  }
 }
 
 /*
 tick_handler takes 2 arguments: the strucutre for the time
   and a value to describe that the time has changed
-Function runs update_time function
+Function runs update_time function with the time it was given
 Function also updates the weather conditions on watch face
   every 30minutes.
 */
 static void tick_handler(struct tm *tick_time, TimeUnits units_changed)
 {
-  update_time();
+  uint32_t start = telemetry_timer_start();
+  update_time(tick_time);
+  
+  //Run any deferred work that is due while the face is awake anyway
+  scheduler_tick();
   
   //Get weather update every 30 minutes
   if(tick_time->tm_min % 30 == 0)
   {
-    //Begin dictionary
+    //Begin dictionary (this fails if AppMessage is not open yet)
     DictionaryIterator *iter;
-    app_message_outbox_begin(&iter);
-    
-    //Add a key-value pair
-    dict_write_uint8(iter,0,0);
-    
-    //Send the message!
-    app_message_outbox_send();
+    if(app_message_outbox_begin(&iter) == APP_MSG_OK)
+    {
+      //Add a key-value pair
+      dict_write_uint8(iter,0,0);
+      
+      //Send the message!
+      app_message_outbox_send();
+    }
   }
+  
+#if STREAM_BACKGROUND
+  //Log the last minute's background streaming as its mean time per redraw
+  if(s_stream_redraws > 0)
+  {
+    telemetry_log(TELEMETRY_HANDLER_TIME, TELEMETRY_BACKGROUND_STREAM,
+                  (uint16_t)MIN(s_stream_ms / s_stream_redraws, 0xFFFF));
+    s_stream_ms = 0;
+    s_stream_redraws = 0;
+  }
+#endif
+  
+  telemetry_timer_stop(TELEMETRY_TICK_HANDLER, start);
 }
 
 /*
@@ -84,66 +405,432 @@ Function updates pointer to battery level and marks the layer
 static void battery_callback(BatteryChargeState state)
 {
   //Record the new battery level
-  s_battery_level = state.charge_percent;
+  s_state.battery_level = state.charge_percent;
+  telemetry_log(TELEMETRY_BATTERY, state.is_charging, state.charge_percent);
   
   //Update meter
-  layer_mark_dirty(s_battery_layer);
+  frame_request(FRAME_BATTERY);
 }
 
+/*
+battery_draw_fast takes 3 arguments: the layer, the context and the
+  width of the bar
+Function writes the battery meter straight into the 8-bit frame buffer a
+  word at a time, returning false if the frame buffer is not available
+  so the caller can draw it the standard way
+*/
+static bool battery_draw_fast(Layer *layer, GContext *ctx, int width)
+{
+#if FAST_BATTERY_BAR && defined(PBL_COLOR)
+  GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+  if(!frame_buffer)
+  {
+    return false;
+  }
+  
+  //The battery layer sits directly on the root layer, so its frame is in
+  //screen coordinates
+  GRect frame = layer_get_frame(layer);
+  for(int y = frame.origin.y; y < frame.origin.y + frame.size.h; y++)
+  {
+    uint8_t *row = gbitmap_get_data_row_info(frame_buffer, y).data;
+    blit_fill_span_8bit(row, frame.origin.x, width, FACE_THEME()->accent.argb);
+    blit_fill_span_8bit(row, frame.origin.x + width, frame.size.w - width, FACE_THEME()->paper.argb);
+  }
+  
+  graphics_release_frame_buffer(ctx, frame_buffer);
+  return true;
+#else
+  return false;
+#endif
+}
+
+#if MONOSPACE_TEXT
+/*
+date_update_proc takes 2 arguments: the date layer and its graphics context
+Function draws the date line with the monospace glyph renderer
+*/
+static void date_update_proc(Layer *layer, GContext *ctx)
+{
+  mono_text_draw(ctx, s_small_font, s_state.date_text, layer_get_frame(layer), FACE_THEME()->ink);
+}
+
+/*
+weather_update_proc takes 2 arguments: the weather layer and its graphics context
+Function draws the weather line with the monospace glyph renderer
+*/
+static void weather_update_proc(Layer *layer, GContext *ctx)
+{
+  mono_text_draw(ctx, s_small_font, s_state.weather_text, layer_get_frame(layer), FACE_THEME()->ink);
+}
+#endif
+
 /*
 battery_update_proc takes 2 arguments: the layer and the context
 Function creates a rectangle to represent the battery percentage
+The first time it runs is the face's first frame, which is timed and
+  then kicks off the deferred startup stages
 */
 static void battery_update_proc(Layer *layer, GContext *ctx)
 {
+  if(!s_first_frame_drawn)
+  {
+    s_first_frame_drawn = true;
+    telemetry_timer_stop(TELEMETRY_FIRST_FRAME, s_launch_ms);
+    LOG_DEBUG("First frame %d ms after launch", (int)(telemetry_timer_start() - s_launch_ms));
+    if(!scheduler_add(0, 0, startup_stage_resources, NULL))
+    {
+      //No room to defer it, so run it now
+      startup_stage_resources(NULL);
+    }
+  }
+  
   GRect bounds = layer_get_bounds(layer);
   
-  //Find the width of the bar
-  int width = (int)(float)(((float)s_battery_level / 100.0F) * 114.0F);
+  //Find the width of the bar; the level is unknown (empty bar) until the
+  //battery service has been subscribed
+  int width = 0;
+  if(s_state.battery_level >= 0)
+  {
+    width = (int)(float)(((float)s_state.battery_level / 100.0F) * 114.0F);
+  }
+  
+  if(battery_draw_fast(layer, ctx, width))
+  {
+    return;
+  }
   
   //Draw the background
-  graphics_context_set_fill_color(ctx, GColorBlack);
+  graphics_context_set_fill_color(ctx, FACE_THEME()->paper);
   graphics_fill_rect(ctx, bounds, GCornerNone, 0);
   
   //Draw the bar
-  graphics_context_set_fill_color(ctx, GColorWhite);
+  graphics_context_set_fill_color(ctx, FACE_THEME()->accent);
   graphics_fill_rect(ctx, GRect(0, 0, width, bounds.size.h), GCornerNone, 0);
 }
 
+#if VECTOR_ICONS
+/*
+bt_icon_update_proc takes 2 arguments: the BT icon layer and the context
+Function draws the vector BT icon, if it is loaded
+*/
+static void bt_icon_update_proc(Layer *layer, GContext *ctx)
+{
+  if(s_bt_icon_image)
+  {
+    gdraw_command_image_draw(ctx, s_bt_icon_image, GPoint(0, 0));
+  }
+}
+#endif
+
+/*
+bt_icon_acquire takes no arguments
+Function loads the bluetooth icon bitmap from resources if it is not
+  already loaded and cancels any pending release of it
+*/
+static void bt_icon_acquire()
+{
+  if(s_bt_icon_release_task)
+  {
+    scheduler_cancel(s_bt_icon_release_task);
+    s_bt_icon_release_task = NULL;
+  }
+  
+  if(!BT_ICON_LOADED())
+  {
+    int heap_before = (int)heap_bytes_free();
+#if VECTOR_ICONS
+    s_bt_icon_image = vector_icon_load(RESOURCE_ID_PDC_BT_ICON,
+                                       layer_get_bounds(s_bt_icon_layer).size);
+    if(s_bt_icon_image)
+    {
+      vector_icon_set_color(s_bt_icon_image, FACE_THEME()->ink);
+    }
+    layer_mark_dirty(s_bt_icon_layer);
+#else
+    s_bt_icon_bitmap = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_BT_ICON);
+    theme_palette_attach(&s_bt_icon_palette, s_bt_icon_bitmap, FACE_THEME());
+    bitmap_layer_set_bitmap(s_bt_icon_layer, s_bt_icon_bitmap);
+#endif
+    LOG_DEBUG("BT icon acquired, %d bytes of heap",
+              heap_before - (int)heap_bytes_free());
+  }
+}
+
+/*
+bt_icon_release takes 1 argument: the task context (unused)
+Function frees the bluetooth icon bitmap once the phone has stayed
+  connected for BT_ICON_RELEASE_DELAY_MS
+*/
+static void bt_icon_release(void *context)
+{
+  s_bt_icon_release_task = NULL;
+  
+  if(BT_ICON_LOADED())
+  {
+    int heap_before = (int)heap_bytes_free();
+#if VECTOR_ICONS
+    gdraw_command_image_destroy(s_bt_icon_image);
+    s_bt_icon_image = NULL;
+#else
+    bitmap_layer_set_bitmap(s_bt_icon_layer, NULL);
+    gbitmap_destroy(s_bt_icon_bitmap);
+    s_bt_icon_bitmap = NULL;
+#endif
+    LOG_DEBUG("BT icon released, %d bytes of heap returned",
+              (int)heap_bytes_free() - heap_before);
+  }
+}
+
+/*
+bt_vibe_allowed takes no arguments
+Function returns whether another disconnect vibration fits in the rate
+  limit, and records it if so. The last BT_VIBE_LIMIT vibration times are
+  kept in a ring; a new one is allowed once the oldest has left the window
+*/
+static bool bt_vibe_allowed()
+{
+  time_t now = time(NULL);
+  time_t oldest = s_bt_vibe_times[s_bt_vibe_index];
+  
+  if(oldest != 0 && now - oldest < BT_VIBE_WINDOW_S)
+  {
+    return false;
+  }
+  
+  s_bt_vibe_times[s_bt_vibe_index] = now;
+  s_bt_vibe_index = (s_bt_vibe_index + 1) % BT_VIBE_LIMIT;
+  return true;
+}
+
+/*
+bt_debounce_expired takes 1 argument: the task context (unused)
+Function runs once a disconnect has lasted BT_DEBOUNCE_MS. If the phone is
+  still disconnected, the image of the bluetooth is loaded and displayed
+  and the watch issues a vibrating alert (subject to the rate limit)
+*/
+static void bt_debounce_expired(void *context)
+{
+  s_bt_debounce_task = NULL;
+  
+  if(connection_service_peek_pebble_app_connection())
+  {
+    return;
+  }
+  
+  //Load and show the icon
+  s_state.connected = false;
+  bt_icon_acquire();
+  frame_request(FRAME_BLUETOOTH);
+  
+  if(bt_vibe_allowed())
+  {
+    //Issue a vibrating alert
+    vibes_double_pulse();
+  }
+  else
+  {
+    s_bt_suppressed_vibes++;
+    LOG_INFO(EVENT_BT_VIBE_LIMITED, s_bt_suppressed_vibes);
+  }
+}
+
 /*
 bluetooth_callback takes 1 argument: a boolean representing whether
   the phone and the watch are connectedd or not
 If the phone is connected to the watch, the image of the bluetooth
-  does not display
-If the phone is not connected to the watch, the image of the
-  bluetooth displays and the watch issues a vibrating alert
+  does not display and its bitmap is freed after a short delay. A
+  reconnect inside the debounce window cancels the pending alert
+If the phone is not connected to the watch, the alert is deferred by
+  BT_DEBOUNCE_MS (see bt_debounce_expired)
 */
 static void bluetooth_callback(bool connected)
 {
-  //Show icon if disconnected
-  layer_set_hidden(bitmap_layer_get_layer(s_bt_icon_layer), connected);
+  telemetry_log(TELEMETRY_CONNECTION, 0, connected);
   
-  if(!connected)
+  if(connected)
   {
-    //Issue a vibrating alert
-    vibes_double_pulse();
+    if(s_bt_debounce_task)
+    {
+      //The disconnect was only a blip, nothing was shown for it
+      scheduler_cancel(s_bt_debounce_task);
+      s_bt_debounce_task = NULL;
+      s_bt_suppressed_disconnects++;
+      LOG_INFO(EVENT_BT_BLIP_DEBOUNCED, s_bt_suppressed_disconnects);
+      return;
+    }
+    
+    //Hide the icon and free its bitmap if the connection holds
+    s_state.connected = true;
+    frame_request(FRAME_BLUETOOTH);
+    if(BT_ICON_LOADED() && !s_bt_icon_release_task)
+    {
+      s_bt_icon_release_task = scheduler_add(BT_ICON_RELEASE_DELAY_MS, BT_ICON_RELEASE_DELAY_MS,
+                                            bt_icon_release, NULL);
+      if(!s_bt_icon_release_task)
+      {
+        bt_icon_release(NULL);
+      }
+    }
+  }
+  else if(!s_bt_debounce_task)
+  {
+    //Wait to see whether the disconnect lasts
+    s_bt_debounce_task = scheduler_add(BT_DEBOUNCE_MS, BT_DEBOUNCE_TOLERANCE_MS,
+                                       bt_debounce_expired, NULL);
+    if(!s_bt_debounce_task)
+    {
+      //No room to wait, so treat the disconnect as lasting
+      bt_debounce_expired(NULL);
+    }
+  }
+}
+
+
+/*
+static_scene_invalidate takes no arguments
+Function marks the static scene dirty so it is drawn again, for when the
+  background or layout changes
+*/
+static void static_scene_invalidate()
+{
+  if(s_background_layer)
+  {
+    layer_mark_dirty(s_background_layer);
   }
 }
 
+/*
+static_scene_update_proc takes 2 arguments: the layer and the context
+Function draws the parts of the face that never change: the black bar
+  behind the date and the background image behind the time
+*/
+static void static_scene_update_proc(Layer *layer, GContext *ctx)
+{
+  GRect bounds = layer_get_bounds(layer);
+  GRect date_bar = DATE_BAR_RECT(bounds);
+  
+  //Draw the date bar
+  graphics_context_set_fill_color(ctx, FACE_THEME()->paper);
+  graphics_fill_rect(ctx, date_bar, 0, GCornerNone);
+  
+#if STREAM_BACKGROUND
+  //The background is opened by the first startup stage
+  if(!s_background_stream)
+  {
+    return;
+  }
+  
+  //Stream the background into the center of the window, timing the reads
+  GSize size = stream_bitmap_get_size(s_background_stream);
+  GPoint origin = GPoint((bounds.size.w - size.w) / 2, (bounds.size.h - size.h) / 2);
+  uint32_t start = telemetry_timer_start();
+  size_t bytes_read = stream_bitmap_draw(ctx, s_background_stream, origin);
+  uint32_t elapsed = telemetry_timer_start() - start;
+  s_stream_ms += elapsed;
+  s_stream_redraws++;
+  LOG_DEBUG("Streamed %d background bytes in %d ms", (int)bytes_read, (int)elapsed);
+#elif TILED_BACKGROUND
+  //The background is loaded by the first startup stage
+  if(!s_background_tiles)
+  {
+    return;
+  }
+  
+  //Draw the tiles in the center of the window
+  GSize size = tiled_bitmap_get_size(s_background_tiles);
+  GPoint origin = GPoint((bounds.size.w - size.w) / 2, (bounds.size.h - size.h) / 2);
+  int tiles_drawn = tiled_bitmap_draw(ctx, s_background_tiles, origin);
+  LOG_DEBUG("Drew %d background tiles", tiles_drawn);
+#else
+  //The background is loaded by the first startup stage
+  if(!s_background_bitmap)
+  {
+    return;
+  }
+  
+  //Draw the background in the center of the window
+  GSize size = gbitmap_get_bounds(s_background_bitmap).size;
+  GRect background = GRect((bounds.size.w - size.w) / 2, (bounds.size.h - size.h) / 2,
+                           size.w, size.h);
+  graphics_draw_bitmap_in_rect(ctx, s_background_bitmap, background);
+#endif
+}
+
+/*
+load_resources takes no arguments
+Function loads the fonts used by the watch face once for the lifetime
+  of the app, so that pushing and popping the window only creates and
+  destroys the (small) layers and never churns the heap with large font
+  allocations. Only what the first frame needs is loaded here; the
+  background bitmap follows in startup_stage_resources
+*/
+static void load_resources()
+{
+  //Load the long-lived resources first so they sit together at the
+  //bottom of the heap
+  s_time_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_PERFECT_DOS_48));
+#if MONOSPACE_TEXT
+  s_small_font = mono_font_load(RESOURCE_ID_GLYPHS_DOS_18);
+#else
+  s_small_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_PERFECT_DOS_18));
+#endif
+  
+  //The BT icon bitmap is only loaded while disconnected (see bt_icon_acquire)
+}
+
+/*
+unload_resources takes no arguments
+Function frees the fonts and bitmaps loaded for the watch face, in the
+  reverse order they were loaded
+*/
+static void unload_resources()
+{
+  if(s_weather_icon)
+  {
+    gbitmap_destroy(s_weather_icon);
+  }
+  if(s_weather_sprites)
+  {
+    gbitmap_destroy(s_weather_sprites);
+  }
+#if STREAM_BACKGROUND
+  if(s_background_stream)
+  {
+    stream_bitmap_close(s_background_stream);
+  }
+#elif TILED_BACKGROUND
+  if(s_background_tiles)
+  {
+    tiled_bitmap_destroy(s_background_tiles);
+  }
+#else
+  if(s_background_bitmap)
+  {
+    gbitmap_destroy(s_background_bitmap);
+  }
+#endif
+#if MONOSPACE_TEXT
+  mono_font_unload(s_small_font);
+#else
+  fonts_unload_custom_font(s_small_font);
+#endif
+  fonts_unload_custom_font(s_time_font);
+}
 
 /*
 main_window_load takes 1 argument: the main window of the watch face
 Function builds the watch face (using the following steps):
 1. Gets information about the size of the window
-2. Creates a TextLayer for the date and prints this above the time
-3. Creates a GBitmap for the background image behind the time
-  and prints this in the center of the window
+2. Creates a Layer for the static scene: the date bar and the background
+  image behind the time, in the center of the window
+3. Creates a TextLayer for the date and prints this above the time
 4. Creates a TextLayer for the time and prints this in the middle
   of the window
 5. Creates a TextLayer for the weather conditions and prints this
   underneath the time layer
 6. Creates a rectangle to represent the battery level of the Pebble
-7. Creates the bluetooth image to represent when the watch is not connected
+7. Creates the bluetooth image layer to represent when the watch is not connected
 */
 static void main_window_load(Window *window)
 {
@@ -151,51 +838,67 @@ static void main_window_load(Window *window)
   Layer *window_layer = window_get_root_layer(window);
   GRect bounds = layer_get_bounds(window_layer);
   
+  //Create the static scene Layer underneath everything else (background)
+  s_background_layer = layer_create(bounds);
+  layer_set_update_proc(s_background_layer, static_scene_update_proc);
+  layer_add_child(window_layer, s_background_layer);
+  
+#if MONOSPACE_TEXT
+  //Create the monospace line with specific bounds (date)
+  s_date_layer = layer_create(DATE_BAR_RECT(bounds));
+  layer_set_update_proc(s_date_layer, date_update_proc);
+  layer_add_child(window_layer, s_date_layer);
+#else
   //Create the TextLayer with specific bounds (date)
-  s_date_layer = text_layer_create(
-    GRect(0, 20,bounds.size.w,50));
-  //Create GFont
-  s_date_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_PERFECT_DOS_18));
-  //Set values for TextLayer (date)
-  text_layer_set_background_color(s_date_layer,GColorBlack);
-  text_layer_set_text_color(s_date_layer,GColorWhite);
+  s_date_layer = text_layer_create(DATE_BAR_RECT(bounds));
+  //Set values for TextLayer (date), the bar behind it is part of the static scene
+  text_layer_set_background_color(s_date_layer,GColorClear);
+  text_layer_set_text_color(s_date_layer,FACE_THEME()->ink);
   text_layer_set_text_alignment(s_date_layer,GTextAlignmentCenter);
-  text_layer_set_font(s_date_layer,s_date_font);
+  text_layer_set_font(s_date_layer,s_small_font);
+  text_layer_set_text(s_date_layer, s_state.date_text);
   //Add it as a child layer to the Window's root layer (date)
   layer_add_child(window_layer,text_layer_get_layer(s_date_layer));
-  
-  //Create GBitmap (background)
-  s_background_bitmap = gbitmap_create_with_resource(RESOURCE_ID_BACKGROUND);
-  //Create BitmapLayer to display the GBitmap (background)
-  s_background_layer = bitmap_layer_create(bounds);
-  //Set the bitmap onto the layer and add to the window (background)
-  bitmap_layer_set_bitmap(s_background_layer, s_background_bitmap);
-  layer_add_child(window_layer, bitmap_layer_get_layer(s_background_layer));
+#endif
   
   //Create the TextLayer with specific bounds (time)
   s_time_layer = text_layer_create(
     GRect(0, PBL_IF_ROUND_ELSE(58,52), bounds.size.w, 50));
-  //Create GFont (time)
-  s_time_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_PERFECT_DOS_48));
   //Improve the layout to be more like a watchface (time)
   text_layer_set_background_color(s_time_layer,GColorClear);
-  text_layer_set_text_color(s_time_layer,GColorBlack);
+  text_layer_set_text_color(s_time_layer,FACE_THEME()->paper);
   text_layer_set_font(s_time_layer,s_time_font);
   text_layer_set_text_alignment(s_time_layer,GTextAlignmentCenter);
+  text_layer_set_text(s_time_layer, s_state.time_text);
   //Add it as a child layer to the Window's root layer (time)
   layer_add_child(window_layer, text_layer_get_layer(s_time_layer));
   
+#if MONOSPACE_TEXT
+  //Create the monospace line (weather)
+  s_weather_layer = layer_create(WEATHER_TEXT_RECT(bounds));
+  layer_set_update_proc(s_weather_layer, weather_update_proc);
+  layer_add_child(window_layer, s_weather_layer);
+#else
   //Create temperature layer (weather)
-  s_weather_layer = text_layer_create(
-    GRect(0, PBL_IF_ROUND_ELSE(125,120), bounds.size.w, 25));
-  //Create second custom font, apply it and add to Window (weather)
-  s_weather_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_PERFECT_DOS_18));
-  text_layer_set_font(s_weather_layer,s_weather_font);
+  s_weather_layer = text_layer_create(WEATHER_TEXT_RECT(bounds));
+  //Apply the shared small font and add to Window (weather)
+  text_layer_set_font(s_weather_layer,s_small_font);
   layer_add_child(window_get_root_layer(window), text_layer_get_layer(s_weather_layer));
   //Style the text (weather)
   text_layer_set_background_color(s_weather_layer, GColorClear);
-  text_layer_set_text_color(s_weather_layer, GColorWhite);
+  text_layer_set_text_color(s_weather_layer, FACE_THEME()->ink);
   text_layer_set_text_alignment(s_weather_layer, GTextAlignmentCenter);
+  //Show the saved weather until new weather arrives (weather)
+  text_layer_set_text(s_weather_layer, s_state.weather_text);
+#endif
+  
+  //Create the weather icon; it stays hidden until the first startup stage
+  //has loaded the sprite sheet (weather)
+  s_weather_icon_layer = bitmap_layer_create(WEATHER_ICON_RECT);
+  bitmap_layer_set_compositing_mode(s_weather_icon_layer, GCompOpSet);
+  bitmap_layer_set_bitmap(s_weather_icon_layer, s_weather_icon);
+  layer_add_child(window_layer, bitmap_layer_get_layer(s_weather_icon_layer));
+  weather_icon_update();
   
   //Create battery meter Layer (battery)
   s_battery_layer = layer_create(GRect(14, 54, 115, 2));
@@ -203,145 +906,296 @@ static void main_window_load(Window *window)
   //Add to Window(battery)
   layer_add_child(window_get_root_layer(window), s_battery_layer);
   
-  //Create the Bluetooth icon GBitmap (bluetooth)
-  s_bt_icon_bitmap = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_BT_ICON);
+#if VECTOR_ICONS
+  //Create the vector BT icon's Layer, scaled with the screen (bluetooth)
+  s_bt_icon_layer = layer_create(GRect(59 * bounds.size.w / 144, 12 * bounds.size.h / 168,
+                                       30 * bounds.size.w / 144, 30 * bounds.size.w / 144));
+  layer_set_update_proc(s_bt_icon_layer, bt_icon_update_proc);
+  layer_add_child(window_layer, s_bt_icon_layer);
+#else
   //Create the BitmapLayer to display the GBitmap (bluetooth)
   s_bt_icon_layer = bitmap_layer_create(GRect(59, 12, 30, 30));
-  bitmap_layer_set_bitmap(s_bt_icon_layer, s_bt_icon_bitmap);
   layer_add_child(window_get_root_layer(window), bitmap_layer_get_layer(s_bt_icon_layer));
-  //Show the correct state of the BT connection from the start (bluetooth)
-  bluetooth_callback(connection_service_peek_pebble_app_connection());
+#endif
+  //Show the correct state of the BT connection once the connection
+  //service is running, and the saved state until then (bluetooth)
+  if(s_startup_complete)
+  {
+    bluetooth_callback(connection_service_peek_pebble_app_connection());
+  }
+  else if(!s_state.connected)
+  {
+    bt_icon_acquire();
+  }
+  else
+  {
+    layer_set_hidden(BT_ICON_LAYER(), true);
+  }
+  
+  LOG_DEBUG("Heap free after load: %d", (int)heap_bytes_free());
 }
 
 /*
 main_window_unload takes 1 argument: the main window of the
   watch face
-Function destroys any TextLayers, GFonts, GBitmaps, or Bitmaps
-  created in the main_window_load function
+Function destroys the layers created in the main_window_load function
+  in the reverse order they were created, so the heap returns to the
+  same shape it had before the window was loaded
 */
 static void main_window_unload(Window *window)
 {
-  //Destroy TextLayer
-  text_layer_destroy(s_time_layer);
-  text_layer_destroy(s_date_layer);
+  //Drop any redraw that was waiting for these layers
+  frame_cancel();
   
-  //Unload GFont
-  fonts_unload_custom_font(s_time_font);
-  fonts_unload_custom_font(s_date_font);
+  //Destroy the objects associated with the bluetooth thing
+  if(s_bt_debounce_task)
+  {
+    scheduler_cancel(s_bt_debounce_task);
+    s_bt_debounce_task = NULL;
+  }
+  if(s_bt_icon_release_task)
+  {
+    scheduler_cancel(s_bt_icon_release_task);
+  }
+  bt_icon_release(NULL);
+#if VECTOR_ICONS
+  layer_destroy(s_bt_icon_layer);
+#else
+  bitmap_layer_destroy(s_bt_icon_layer);
+#endif
+  
+  //Destroy the battery meter
+  layer_destroy(s_battery_layer);
   
-  //Destroy GBitmap
-  gbitmap_destroy(s_background_bitmap);
-  //Destroy BitmapLayer
-  bitmap_layer_destroy(s_background_layer);
+  //Destroy the weather icon (the sprite sheet is kept with the resources)
+  bitmap_layer_destroy(s_weather_icon_layer);
+  s_weather_icon_layer = NULL;
   
   //Destroy weather elements
+#if MONOSPACE_TEXT
+  layer_destroy(s_weather_layer);
+#else
   text_layer_destroy(s_weather_layer);
-  fonts_unload_custom_font(s_weather_font);
+#endif
   
-  //Destroy the battery meter
-  layer_destroy(s_battery_layer);
+  //Destroy TextLayer (time)
+  text_layer_destroy(s_time_layer);
   
-  //Destroy the objects associated with the bluetooth thing
-  gbitmap_destroy(s_bt_icon_bitmap);
-  bitmap_layer_destroy(s_bt_icon_layer);
+  //Destroy TextLayer (date)
+#if MONOSPACE_TEXT
+  layer_destroy(s_date_layer);
+#else
+  text_layer_destroy(s_date_layer);
+#endif
+  
+  //Destroy the static scene
+  layer_destroy(s_background_layer);
+  s_background_layer = NULL;
+  
+  LOG_DEBUG("Heap free after unload: %d, %d frame requests coalesced",
+            (int)heap_bytes_free(), frame_coalesced_count());
 }
 
+/*
+InboxMessage holds the values read out of one incoming
+  message. The conditions string points into the message itself and is
+  only valid during inbox_received_callback
+*/
+typedef struct
+{
+  bool has_temperature;
+  int temperature;
+  int weather_code;
+  const char *conditions;
+} InboxMessage;
+
+/*
+inbox_read_temperature and inbox_read_conditions take 2 arguments: the
+  tuple for their message key and the message being assembled
+Functions copy the tuple's value into the message
+*/
+static void inbox_read_temperature(const Tuple *tuple, InboxMessage *message)
+{
+  message->has_temperature = true;
+  message->temperature = (int)tuple->value->int32;
+}
+
+static void inbox_read_conditions(const Tuple *tuple, InboxMessage *message)
+{
+  message->conditions = tuple->value->cstring;
+}
+
+/*
+inbox_read_weather_icon takes 2 arguments: the tuple and the message
+Function copies the OpenWeatherMap condition code into the message; it
+  picks the weather icon (see weather_icon_index)
+*/
+static void inbox_read_weather_icon(const Tuple *tuple, InboxMessage *message)
+{
+  message->weather_code = (int)tuple->value->int32;
+}
+
+/*
+inbox_read_log_dump takes 2 arguments: the tuple and the message (unused)
+Function starts sending the event log to the phone, which asked for it
+*/
+static void inbox_read_log_dump(const Tuple *tuple, InboxMessage *message)
+{
+  event_log_dump_start();
+}
+
+/*
+inbox_read_theme takes 2 arguments: the tuple and the message (unused)
+Function switches the face to the theme the phone picked
+*/
+static void inbox_read_theme(const Tuple *tuple, InboxMessage *message)
+{
+  int theme = (int)tuple->value->int32;
+  if(theme >= 0 && theme < theme_count() && theme != s_state.theme)
+  {
+    s_state.theme = theme;
+    frame_request(FRAME_THEME);
+  }
+}
+
+//Routes each incoming tuple to its handler by message key
+typedef void (*InboxTupleHandler)(const Tuple *tuple, InboxMessage *message);
+static const struct
+{
+  const uint32_t *key;
+  InboxTupleHandler handler;
+} s_inbox_handlers[] =
+{
+  { &MESSAGE_KEY_TEMPERATURE, inbox_read_temperature },
+  { &MESSAGE_KEY_CONDITIONS, inbox_read_conditions },
+  { &MESSAGE_KEY_WEATHER_ICON, inbox_read_weather_icon },
+  { &MESSAGE_KEY_LOG_DUMP, inbox_read_log_dump },
+  { &MESSAGE_KEY_THEME, inbox_read_theme },
+};
+
 /*
 inbox_received_callback takes 2 arguments: a DictionaryIterator
   and the context
-Function stores the data for the weather fetched from the JavaScript
-  and only uses it if all of the data is available
+Function walks the message once, handing each tuple to the handler
+  registered for its key, and only uses the weather data if all of it
+  is available
 */
 static void inbox_received_callback(DictionaryIterator *iterator, void *context)
 {
-  //Store incoming information
-  static char temperature_buffer[8];
-  static char conditions_buffer[32];
-  static char weather_layer_buffer[32];
+  uint32_t start = telemetry_timer_start();
   
-  //Read tuples for data
-  Tuple *temp_tuple = dict_find(iterator, MESSAGE_KEY_TEMPERATURE);
-  Tuple *conditions_tuple = dict_find(iterator, MESSAGE_KEY_CONDITIONS);
+  InboxMessage message = { .has_temperature = false, .weather_code = 0, .conditions = NULL };
   
-  //If all data is available, use it
-  if(temp_tuple && conditions_tuple)
+  //Read every tuple once and dispatch it by key
+  for(Tuple *tuple = dict_read_first(iterator); tuple; tuple = dict_read_next(iterator))
   {
-    snprintf(temperature_buffer, sizeof(temperature_buffer), "%dF", (int)temp_tuple->value->int32);
-    snprintf(conditions_buffer, sizeof(conditions_buffer), "%s", conditions_tuple->value->cstring);
+    for(unsigned int i = 0; i < ARRAY_LENGTH(s_inbox_handlers); i++)
+    {
+      if(tuple->key == *s_inbox_handlers[i].key)
+      {
+        s_inbox_handlers[i].handler(tuple, &message);
+        break;
+      }
+    }
+  }
+  
+  //If all data is available, store it, assemble full string and display
+  if(message.has_temperature && message.conditions)
+  {
+    s_state.has_weather = true;
+    s_state.temperature = (int16_t)message.temperature;
+    s_state.weather_code = (int16_t)message.weather_code;
+    s_state.weather_time = (uint32_t)time(NULL);
+    fmt_copy(s_state.conditions, message.conditions, sizeof(s_state.conditions));
     
-    //Assemble full string and display
-    snprintf(weather_layer_buffer, sizeof(weather_layer_buffer), "%s, %s", temperature_buffer, conditions_buffer);
-    text_layer_set_text(s_weather_layer, weather_layer_buffer);
+    FmtWriter writer;
+    fmt_begin(&writer, s_state.weather_text, sizeof(s_state.weather_text));
+    fmt_int_unit(&writer, message.temperature, "F");
+    fmt_str(&writer, ", ");
+    fmt_str(&writer, message.conditions);
+    frame_request(FRAME_WEATHER);
   }
+  
+  telemetry_timer_stop(TELEMETRY_INBOX_RECEIVED, start);
 }
 
 /*
 inbox_dropped_callback takes 2 arguments: the reason the message
   dropped and the context
-Function prints to the app log that the message dropped
+Function records the drop and its reason in the event log
 */
 static void inbox_dropped_callback(AppMessageResult reason, void *context)
 {
-  APP_LOG(APP_LOG_LEVEL_ERROR, "Message dropped!");
+  LOG_ERROR(EVENT_INBOX_DROPPED, reason);
+  telemetry_log(TELEMETRY_MESSAGE_DROPPED, EVENT_INBOX_DROPPED, reason);
 }
 
 /*
 outbox_failed_callback takes 3 arguments: a DictionaryIterator,
   the reason the outbox send failed, and the context
-Function prints to the app log that the outbox send failed
+Function records the failure and its reason in the event log, and ends
+  the event log dump if the message was one of its chunks
 */
 static void outbox_failed_callback(DictionaryIterator *iterator, AppMessageResult reason, void *context)
 {
-  APP_LOG(APP_LOG_LEVEL_ERROR, "Outbox send failed!");
+  LOG_ERROR(EVENT_OUTBOX_FAILED, reason);
+  telemetry_log(TELEMETRY_MESSAGE_DROPPED, EVENT_OUTBOX_FAILED, reason);
+  
+  //The phone can ask for the log again
+  if(dict_find(iterator, MESSAGE_KEY_LOG_RECORDS))
+  {
+    event_log_dump_cancel();
+  }
 }
 
 /*
 outbox_sent_callback takes 2 arguments: a DictionaryIterator and the context
-Function prints to the app log that the outbox send was a success
+Function sends the next chunk of the event log if a dump is in progress
 */
 static void outbox_sent_callback(DictionaryIterator *iterator, void *context)
 {
-  APP_LOG(APP_LOG_LEVEL_INFO, "Outbox send success!");
+  event_log_dump_continue();
 }
 
 /*
-init takes no arguments
-Function creates the elements of the watch face (in the following order):
-1. Creates main Window element
-2. Sets handlers to manage elements inside the Window
-3. Shows the window on the watch and makes it animated
-4. Registers TickTimerService to change the time
-5. Ensures that the time is displayed from when the watch face
-  is opened
-6. Sets the background color of the window to black
-7. Registers callbacks for the weather functionality
-8. Opens AppMessage
-9. Registers for battery level updates and ensures that
-  battery level is displayed from when the watch face
-  is opened
-10. Registers for bluetooth connection updates
+snapshot_restore takes no arguments
+Function loads the face state saved by the last run, if there is one
+  with the current layout version, so the first frame shows it
 */
-static void init()
+static void snapshot_restore()
 {
-  //Create main Window element and assign to pointer
-  s_main_window = window_create();
-  //Set handlers to manage the elements inside the Window
-  window_set_window_handlers(s_main_window,(WindowHandlers)
+  FaceState saved;
+  if(persist_read_data(SNAPSHOT_KEY, &saved, sizeof(saved)) == (int)sizeof(saved) &&
+     saved.version == SNAPSHOT_VERSION)
   {
-    .load = main_window_load,
-    .unload = main_window_unload
-  });
-  //Show the Window on the watch, with animated = true
-  window_stack_push(s_main_window,true);
+    //Persisted data is not trusted to hold terminated strings
+    saved.conditions[sizeof(saved.conditions) - 1] = '\0';
+    saved.time_text[sizeof(saved.time_text) - 1] = '\0';
+    saved.date_text[sizeof(saved.date_text) - 1] = '\0';
+    saved.weather_text[sizeof(saved.weather_text) - 1] = '\0';
+    s_state = saved;
+  }
+}
 
-  //Register with TickTimerService
-  tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
-  //Make sure the time is displayed from the start
-  update_time();
-  
-  //Sets background color of the Window to black
-  window_set_background_color(s_main_window,GColorBlack);
-  
+/*
+snapshot_save takes no arguments
+Function saves the face state in a single persist write
+*/
+static void snapshot_save()
+{
+  s_state.version = SNAPSHOT_VERSION;
+  persist_write_data(SNAPSHOT_KEY, &s_state, sizeof(s_state));
+}
+
+/*
+startup_stage_services takes 1 argument: the task context (unused)
+Second deferred startup stage, run after startup_stage_resources:
+1. Registers callbacks for the weather functionality and opens AppMessage
+2. Registers for bluetooth connection updates and shows the current
+  connection state
+*/
+static void startup_stage_services(void *context)
+{
   //Register callbacks
   app_message_register_inbox_received(inbox_received_callback);
   app_message_register_inbox_dropped(inbox_dropped_callback);
@@ -352,27 +1206,126 @@ static void init()
   const int outbox_size = 128;
   app_message_open(inbox_size, outbox_size);
   
+  //Register for Bluetooth connection updates
+  connection_service_subscribe((ConnectionHandlers)
+  {
+    .pebble_app_connection_handler = bluetooth_callback
+  });
+  //Show the correct state of the BT connection
+  bluetooth_callback(connection_service_peek_pebble_app_connection());
+  
+  s_startup_complete = true;
+}
+
+/*
+startup_stage_resources takes 1 argument: the task context (unused)
+First deferred startup stage, run once the first frame is on screen:
+1. Loads the background bitmap and shows it behind the time
+2. Loads the weather sprite sheet and shows the current condition's icon
+3. Registers for battery level updates and displays the current level
+*/
+static void startup_stage_resources(void *context)
+{
+  //Load the background and put it on its layer
+#if STREAM_BACKGROUND
+  s_background_stream = stream_bitmap_open(RESOURCE_ID_BACKGROUND);
+#elif TILED_BACKGROUND
+  s_background_tiles = tiled_bitmap_load(RESOURCE_ID_BACKGROUND_TILES,
+                                         RESOURCE_ID_BACKGROUND_TILEMAP);
+#else
+  s_background_bitmap = gbitmap_create_with_resource(RESOURCE_ID_BACKGROUND);
+  theme_palette_attach(&s_background_palette, s_background_bitmap, FACE_THEME());
+#endif
+  static_scene_invalidate();
+  
+  //Load the weather icons and point the icon at the current condition
+  s_weather_sprites = gbitmap_create_with_resource(RESOURCE_ID_WEATHER_SPRITES);
+  if(s_weather_sprites)
+  {
+    theme_palette_attach(&s_weather_sprites_palette, s_weather_sprites, FACE_THEME());
+    s_weather_icon = gbitmap_create_as_sub_bitmap(s_weather_sprites,
+      GRect(0, 0, WEATHER_ICON_SIZE, WEATHER_ICON_SIZE));
+  }
+  if(s_weather_icon_layer)
+  {
+    bitmap_layer_set_bitmap(s_weather_icon_layer, s_weather_icon);
+    weather_icon_update();
+  }
+  
   //Register for battery level updates
   battery_state_service_subscribe(battery_callback);
-  //Ensure battery level is displayed from the start
+  //Display the current battery level
   battery_callback(battery_state_service_peek());
   
-  //Register for Bluetooth connection updates
-  connection_service_subscribe((ConnectionHandlers)
+  //Run the next stage as its own event so input stays responsive
+  if(!scheduler_add(0, 0, startup_stage_services, NULL))
   {
-    .pebble_app_connection_handler = bluetooth_callback
+    startup_stage_services(NULL);
+  }
+}
+
+/*
+init takes no arguments
+Function creates only what the first frame needs (in the following order):
+1. Opens telemetry, restores the saved face state, loads the fonts,
+  formats the time and creates main Window element
+2. Sets handlers to manage elements inside the Window
+3. Sets the background color of the window to black
+4. Shows the window on the watch without the push animation
+5. Registers TickTimerService to change the time
+Everything else is set up by the startup stages once the first frame
+  has been drawn (see battery_update_proc)
+*/
+static void init()
+{
+  //Open the telemetry session before any service can report to it
+  telemetry_init();
+  
+  //Restore what the face showed last time before anything is drawn
+  snapshot_restore();
+  
+  //Load fonts once for the lifetime of the app
+  load_resources();
+  //Route every service's redraws through the frame scheduler
+  frame_init(frame_commit_layers);
+  //Format the time before the window loads so the first frame has it
+  update_time_now();
+  
+  //Create main Window element and assign to pointer
+  s_main_window = window_create();
+  //Set handlers to manage the elements inside the Window
+  window_set_window_handlers(s_main_window,(WindowHandlers)
+  {
+    .load = main_window_load,
+    .unload = main_window_unload
   });
+  //Sets background color of the Window to the theme's paper (black)
+  window_set_background_color(s_main_window,FACE_THEME()->paper);
+  //Show the Window on the watch straight away, with animated = false
+  window_stack_push(s_main_window,false);
+
+  //Register with TickTimerService
+  tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
 }
 
 /*
 deinit takes no arguments
-Function destroys the Window element when the user exits the
-  watch face
+Function saves the face state, destroys the Window element, frees the
+  fonts and bitmaps and closes telemetry when the user exits the watch face
 */
 static void deinit()
 {
+  //Save what the face shows for the next launch
+  snapshot_save();
+  
   //Destroy Window
   window_destroy(s_main_window);
+  
+  //Free the fonts and bitmaps once the window no longer uses them
+  unload_resources();
+  
+  //Log the last telemetry batch and close the session
+  telemetry_deinit();
 }
 
 /*
@@ -382,6 +1335,8 @@ Main function builds watch face, waits for user action,
 */
 int main(void)
 {
+  //Note the launch time for the first frame measurement
+  s_launch_ms = telemetry_timer_start();
   init();
   app_event_loop();
   deinit();
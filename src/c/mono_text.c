@@ -0,0 +1,127 @@
+#include <pebble.h>
+#include "mono_text.h"
+#include "blit.h"
+#include "event_log.h"
+
+/*
+The code in this file loads glyph strips and draws text with them.
+*/
+
+//Layout of the glyph strip resource written by tools/glyphs.py
+struct MonoFont
+{
+  uint8_t first_char;
+  uint8_t count;
+  uint8_t width;
+  uint8_t height;
+  uint8_t row_bytes;
+  uint8_t glyphs[];
+};
+
+/*
+mono_font_load takes 1 argument: the glyph strip's resource ID
+Function loads the strip into the heap, returning NULL if it cannot be
+  loaded, its glyph size is not the one compiled in or it is too short to
+  hold the glyphs its header counts
+*/
+MonoFont *mono_font_load(uint32_t resource_id)
+{
+  ResHandle handle = resource_get_handle(resource_id);
+  size_t size = resource_size(handle);
+  if(size < sizeof(MonoFont))
+  {
+    LOG_DEBUG("Glyph strip is %d bytes, too short for its header", (int)size);
+    return NULL;
+  }
+  MonoFont *font = malloc(size);
+  if(!font)
+  {
+    return NULL;
+  }
+  resource_load(handle, (uint8_t *)font, size);
+  
+  if(font->width != MONO_GLYPH_WIDTH || font->height != MONO_GLYPH_HEIGHT ||
+     font->row_bytes != MONO_GLYPH_ROW_BYTES)
+  {
+    LOG_DEBUG("Glyph strip is %dx%d, expected %dx%d", font->width, font->height,
+              MONO_GLYPH_WIDTH, MONO_GLYPH_HEIGHT);
+    free(font);
+    return NULL;
+  }
+  
+  //mono_text_draw indexes glyphs by the header's count, so every one of
+  //them has to be in the resource
+  size_t needed = sizeof(MonoFont) + (size_t)font->count * font->height * font->row_bytes;
+  if(size < needed)
+  {
+    LOG_DEBUG("Glyph strip is %d bytes, its %d glyphs need %d", (int)size,
+              font->count, (int)needed);
+    free(font);
+    return NULL;
+  }
+  return font;
+}
+
+/*
+mono_font_unload takes 1 argument: a font from mono_font_load
+Function frees the font
+*/
+void mono_font_unload(MonoFont *font)
+{
+  free(font);
+}
+
+/*
+mono_text_draw takes 5 arguments: the graphics context, the font, the
+  text, the screen rectangle to center it in and the text color
+Function draws as many characters as fit in the rectangle's width,
+  centered horizontally and aligned to its top
+*/
+void mono_text_draw(GContext *ctx, const MonoFont *font, const char *text,
+                    GRect frame, GColor color)
+{
+  if(!font)
+  {
+    return;
+  }
+  
+  //Centered position is pure arithmetic for a fixed-width font
+  int length = strlen(text);
+  length = MIN(length, frame.size.w / MONO_GLYPH_WIDTH);
+  int x = frame.origin.x + (frame.size.w - length * MONO_GLYPH_WIDTH) / 2;
+  
+  GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+  if(!frame_buffer)
+  {
+    return;
+  }
+  if(frame.origin.y < 0 ||
+     frame.origin.y + MONO_GLYPH_HEIGHT > gbitmap_get_bounds(frame_buffer).size.h)
+  {
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    return;
+  }
+  
+  uint8_t *row = gbitmap_get_data_row_info(frame_buffer, frame.origin.y).data;
+  int stride = gbitmap_get_bytes_per_row(frame_buffer);
+  int glyph_bytes = MONO_GLYPH_HEIGHT * MONO_GLYPH_ROW_BYTES;
+  
+  for(int i = 0; i < length; i++, x += MONO_GLYPH_WIDTH)
+  {
+    int index = (uint8_t)text[i] - font->first_char;
+    if(index < 0 || index >= font->count)
+    {
+      continue;
+    }
+    const uint8_t *glyph = font->glyphs + index * glyph_bytes;
+#if defined(PBL_COLOR)
+    blit_glyph_8bit(row, stride, x, glyph, MONO_GLYPH_ROW_BYTES,
+                    MONO_GLYPH_WIDTH, MONO_GLYPH_HEIGHT, color.argb);
+#else
+    blit_glyph_1bit(row, stride, x, glyph, MONO_GLYPH_ROW_BYTES,
+                    MONO_GLYPH_WIDTH, MONO_GLYPH_HEIGHT, gcolor_equal(color, GColorWhite));
+#endif
+  }
+  
+  graphics_release_frame_buffer(ctx, frame_buffer);
+}
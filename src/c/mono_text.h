@@ -0,0 +1,22 @@
+#pragma once
+#include <pebble.h>
+
+/*
+The monospace text renderer draws single lines of text from a glyph
+strip pre-rasterized ahead of time (see tools/glyphs.py), placing each
+glyph arithmetically and blitting it into the frame buffer instead of
+going through the text layout engine.
+*/
+
+//Glyph size of the RESOURCE_ID_GLYPHS_DOS_18 strip; fixed at compile time
+//so the blitter is unrolled for it
+#define MONO_GLYPH_WIDTH 10
+#define MONO_GLYPH_HEIGHT 18
+#define MONO_GLYPH_ROW_BYTES 2
+
+typedef struct MonoFont MonoFont;
+
+MonoFont *mono_font_load(uint32_t resource_id);
+void mono_font_unload(MonoFont *font);
+void mono_text_draw(GContext *ctx, const MonoFont *font, const char *text,
+                    GRect frame, GColor color);
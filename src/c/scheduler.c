@@ -0,0 +1,229 @@
+#include <pebble.h>
+#include "scheduler.h"
+
+/*
+The code in this file keeps the pending tasks in a list sorted by
+deadline and owns the one app_timer that wakes the face to run them.
+*/
+
+struct SchedulerTask
+{
+  uint32_t deadline;
+  uint32_t latest;
+  SchedulerCallback callback;
+  void *context;
+  SchedulerTask *next;
+  bool active;
+};
+
+static SchedulerTask s_tasks[SCHEDULER_MAX_TASKS];
+//Pending tasks, earliest deadline first
+static SchedulerTask *s_head;
+static AppTimer *s_timer;
+//The time s_timer is set to fire at
+static uint32_t s_timer_wake;
+//Monotonic clock built from the wall clock, and the wall clock reading it
+//last advanced from
+static uint32_t s_now;
+static uint32_t s_last_wall;
+static bool s_clock_started;
+
+/*
+is_before takes 2 arguments: two millisecond timestamps
+Function returns whether a is earlier than b, allowing for wraparound
+*/
+static bool is_before(uint32_t a, uint32_t b)
+{
+  return (int32_t)(a - b) < 0;
+}
+
+/*
+scheduler_now_ms takes no arguments
+Function returns a monotonic time in milliseconds. It advances with the
+  wall clock, but a step backwards counts as no time and a step forwards
+  counts as at most SCHEDULER_MAX_STEP_MS, so setting the clock can
+  neither stall the pending tasks nor run them all at once
+*/
+uint32_t scheduler_now_ms(void)
+{
+  time_t seconds;
+  uint16_t millis;
+  time_ms(&seconds, &millis);
+  uint32_t wall = (uint32_t)seconds * 1000 + millis;
+  
+  if(s_clock_started)
+  {
+    int32_t step = (int32_t)(wall - s_last_wall);
+    s_now += (uint32_t)MIN(MAX(step, 0), SCHEDULER_MAX_STEP_MS);
+  }
+  s_clock_started = true;
+  s_last_wall = wall;
+  return s_now;
+}
+
+static void scheduler_timer_fired(void *context);
+
+/*
+scheduler_arm takes no arguments
+Function points the app_timer at the earliest time any pending task must
+  run by, or cancels it if nothing is pending. A timer already set for that
+  time is left alone, so adding a task that can share the coming wakeup
+  costs no timer call
+*/
+static void scheduler_arm(void)
+{
+  if(!s_head)
+  {
+    if(s_timer)
+    {
+      app_timer_cancel(s_timer);
+      s_timer = NULL;
+    }
+    return;
+  }
+  
+  uint32_t wake = s_head->latest;
+  for(SchedulerTask *task = s_head->next; task; task = task->next)
+  {
+    if(is_before(task->latest, wake))
+    {
+      wake = task->latest;
+    }
+  }
+  
+  if(s_timer && s_timer_wake == wake)
+  {
+    return;
+  }
+  
+  uint32_t now = scheduler_now_ms();
+  uint32_t delay = is_before(now, wake) ? wake - now : 0;
+  if(!s_timer || !app_timer_reschedule(s_timer, delay))
+  {
+    s_timer = app_timer_register(delay, scheduler_timer_fired, NULL);
+  }
+  s_timer_wake = wake;
+}
+
+/*
+scheduler_run_due takes no arguments
+Function runs every task whose deadline has passed or falls within
+  SCHEDULER_MERGE_MS, then re-arms the timer for the rest
+*/
+static void scheduler_run_due(void)
+{
+  uint32_t horizon = scheduler_now_ms() + SCHEDULER_MERGE_MS;
+  
+  //Detach the due tasks before running any, so tasks their callbacks add
+  //wait for a wakeup of their own instead of running in this one
+  SchedulerTask *due = NULL;
+  SchedulerTask **tail = &due;
+  while(s_head && !is_before(horizon, s_head->deadline))
+  {
+    *tail = s_head;
+    tail = &s_head->next;
+    s_head = s_head->next;
+  }
+  *tail = NULL;
+  scheduler_arm();
+  
+  //Due tasks stay active until they run so their slots are not reused;
+  //a task cancelled by an earlier callback has had its callback cleared
+  while(due)
+  {
+    SchedulerTask *task = due;
+    due = task->next;
+    SchedulerCallback callback = task->callback;
+    task->active = false;
+    if(callback)
+    {
+      callback(task->context);
+    }
+  }
+}
+
+/*
+scheduler_timer_fired takes 1 argument: the timer context (unused)
+Function runs the due tasks when the scheduler's timer wakes the face
+*/
+static void scheduler_timer_fired(void *context)
+{
+  s_timer = NULL;
+  scheduler_run_due();
+}
+
+/*
+scheduler_add takes 4 arguments: how long to wait, how much longer the
+  task may be held back to share a wakeup, the callback and its context
+Function returns the task, which stays valid until its callback starts or
+  it is cancelled, or NULL if SCHEDULER_MAX_TASKS tasks are pending
+*/
+SchedulerTask *scheduler_add(uint32_t delay_ms, uint32_t tolerance_ms,
+                             SchedulerCallback callback, void *context)
+{
+  SchedulerTask *task = NULL;
+  for(int i = 0; i < SCHEDULER_MAX_TASKS; i++)
+  {
+    if(!s_tasks[i].active)
+    {
+      task = &s_tasks[i];
+      break;
+    }
+  }
+  if(!task)
+  {
+    return NULL;
+  }
+  
+  task->deadline = scheduler_now_ms() + delay_ms;
+  task->latest = task->deadline + tolerance_ms;
+  task->callback = callback;
+  task->context = context;
+  task->active = true;
+  
+  //Insert in deadline order
+  SchedulerTask **link = &s_head;
+  while(*link && !is_before(task->deadline, (*link)->deadline))
+  {
+    link = &(*link)->next;
+  }
+  task->next = *link;
+  *link = task;
+  
+  scheduler_arm();
+  return task;
+}
+
+/*
+scheduler_cancel takes 1 argument: a pending task
+Function removes the task without running it
+*/
+void scheduler_cancel(SchedulerTask *task)
+{
+  for(SchedulerTask **link = &s_head; *link; link = &(*link)->next)
+  {
+    if(*link == task)
+    {
+      *link = task->next;
+      task->active = false;
+      scheduler_arm();
+      return;
+    }
+  }
+  
+  //Not pending, so it is due in the wakeup that is running now
+  if(task->active)
+  {
+    task->callback = NULL;
+  }
+}
+
+/*
+scheduler_tick takes no arguments
+Function runs the tasks that are already due while the face is awake for
+  the minute tick, which saves them a wakeup of their own
+*/
+void scheduler_tick(void)
+{
+  scheduler_run_due();
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <pebble.h>
+
+/*
+The scheduler runs all of the face's deferred work from a single
+app_timer. Tasks give a delay and a tolerance (how much later than the
+delay they may run); the scheduler sleeps until the first task's
+tolerance runs out and then runs every task that is due, so tasks with
+nearby deadlines share one wakeup. Tasks that are due by the minute tick
+run from tick_handler instead (see scheduler_tick). A task added by a
+callback never runs in the same wakeup, even with no delay.
+*/
+
+//Most tasks that can be pending at once
+#define SCHEDULER_MAX_TASKS 8
+//Tasks due within this many ms of a wakeup run early as part of it
+#define SCHEDULER_MERGE_MS 250
+//Largest forward step of the wall clock counted as elapsed time; the
+//minute tick reads the clock at least this often
+#define SCHEDULER_MAX_STEP_MS 65000
+
+typedef void (*SchedulerCallback)(void *context);
+typedef struct SchedulerTask SchedulerTask;
+
+SchedulerTask *scheduler_add(uint32_t delay_ms, uint32_t tolerance_ms,
+                             SchedulerCallback callback, void *context);
+void scheduler_cancel(SchedulerTask *task);
+void scheduler_tick(void);
+uint32_t scheduler_now_ms(void);
@@ -0,0 +1,195 @@
+#include <pebble.h>
+#include "stream_bitmap.h"
+#include "event_log.h"
+
+/*
+The code in this file reads PBI bitmap resources and draws them into the
+frame buffer band by band.
+*/
+
+//A PBI resource starts with this header, followed by the rows of pixel
+//data and then, for palettized formats, one GColor8 byte per color
+typedef struct __attribute__((packed))
+{
+  uint16_t row_size;
+  uint16_t info_flags;
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+} PbiHeader;
+
+//Pixel format field of PbiHeader.info_flags
+#define PBI_FORMAT(info_flags) (((info_flags) >> 1) & 0x1F)
+
+struct StreamBitmap
+{
+  ResHandle handle;
+  GBitmapFormat format;
+  uint8_t bits_per_pixel;
+  uint16_t row_size;
+  GSize size;
+  uint8_t palette[16];
+  uint8_t band[];
+};
+
+/*
+stream_bitmap_open takes 1 argument: the bitmap's resource ID
+Function reads the bitmap's header and palette and allocates the band
+  buffer, returning NULL if the resource is not a PBI bitmap this file
+  can draw, is too short for its rows and palette or the memory is not
+  available
+*/
+StreamBitmap *stream_bitmap_open(uint32_t resource_id)
+{
+  ResHandle handle = resource_get_handle(resource_id);
+  PbiHeader header;
+  if(resource_load_byte_range(handle, 0, (uint8_t *)&header, sizeof(header)) != sizeof(header))
+  {
+    return NULL;
+  }
+  
+  uint8_t bits_per_pixel;
+  switch(PBI_FORMAT(header.info_flags))
+  {
+    case GBitmapFormat1Bit:
+    case GBitmapFormat1BitPalette: bits_per_pixel = 1; break;
+    case GBitmapFormat2BitPalette: bits_per_pixel = 2; break;
+    case GBitmapFormat4BitPalette: bits_per_pixel = 4; break;
+    case GBitmapFormat8Bit: bits_per_pixel = 8; break;
+    default:
+      LOG_DEBUG("Cannot stream bitmap format %d", PBI_FORMAT(header.info_flags));
+      return NULL;
+  }
+  
+  //The palette follows the pixel data and may hold fewer colors than the
+  //format allows, but the pixel rows and at least one color must be there
+  uint32_t palette_offset = sizeof(header) + header.row_size * header.h;
+  size_t palette_min = PBI_FORMAT(header.info_flags) >= GBitmapFormat1BitPalette ? 1 : 0;
+  size_t resource_bytes = resource_size(handle);
+  if(resource_bytes < palette_offset + palette_min)
+  {
+    LOG_DEBUG("Bitmap is %d bytes, its rows and palette need %d", (int)resource_bytes,
+              (int)(palette_offset + palette_min));
+    return NULL;
+  }
+  size_t palette_size = resource_bytes - palette_offset;
+  
+  StreamBitmap *bitmap = malloc(sizeof(StreamBitmap) + header.row_size * STREAM_BAND_ROWS);
+  if(!bitmap)
+  {
+    return NULL;
+  }
+  bitmap->handle = handle;
+  bitmap->format = PBI_FORMAT(header.info_flags);
+  bitmap->bits_per_pixel = bits_per_pixel;
+  bitmap->row_size = header.row_size;
+  bitmap->size = GSize(header.w, header.h);
+  
+  memset(bitmap->palette, 0, sizeof(bitmap->palette));
+  if(bitmap->format >= GBitmapFormat1BitPalette)
+  {
+    resource_load_byte_range(handle, palette_offset, bitmap->palette,
+                             MIN(palette_size, sizeof(bitmap->palette)));
+  }
+  return bitmap;
+}
+
+/*
+stream_bitmap_close takes 1 argument: a bitmap from stream_bitmap_open
+Function frees the bitmap
+*/
+void stream_bitmap_close(StreamBitmap *bitmap)
+{
+  free(bitmap);
+}
+
+/*
+stream_bitmap_get_size takes 1 argument: the bitmap
+Function returns the bitmap's size in pixels
+*/
+GSize stream_bitmap_get_size(const StreamBitmap *bitmap)
+{
+  return bitmap->size;
+}
+
+/*
+stream_pixel takes 3 arguments: the bitmap, a row in its band buffer and x
+Function returns the GColor8 value of the pixel at x
+*/
+static uint8_t stream_pixel(const StreamBitmap *bitmap, const uint8_t *row, int x)
+{
+  switch(bitmap->format)
+  {
+    case GBitmapFormat8Bit:
+      return row[x];
+    case GBitmapFormat1Bit:
+      //Unpalettized 1-bit rows keep the leftmost pixel in bit 0
+      return (row[x >> 3] >> (x & 7)) & 1 ? GColorWhiteARGB8 : GColorBlackARGB8;
+    default:
+    {
+      //Palettized rows keep the leftmost pixel in the most significant bits
+      int bpp = bitmap->bits_per_pixel;
+      int per_byte = 8 / bpp;
+      int shift = 8 - bpp * (x % per_byte + 1);
+      return bitmap->palette[(row[x / per_byte] >> shift) & ((1 << bpp) - 1)];
+    }
+  }
+}
+
+/*
+stream_bitmap_draw takes 3 arguments: the graphics context, the bitmap and
+  the screen position of its top left corner
+Function reads the bitmap a band of rows at a time and copies each visible
+  pixel into the frame buffer, replacing what was there like
+  GCompOpAssign. Returns how many bytes it read from the resource
+*/
+size_t stream_bitmap_draw(GContext *ctx, StreamBitmap *bitmap, GPoint origin)
+{
+  GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+  if(!frame_buffer)
+  {
+    return 0;
+  }
+  
+  int screen_h = gbitmap_get_bounds(frame_buffer).size.h;
+  int first = MAX(0, -origin.y);
+  int last = MIN(bitmap->size.h, screen_h - origin.y);
+  size_t bytes_read = 0;
+  
+  for(int band = first; band < last; band += STREAM_BAND_ROWS)
+  {
+    int rows = MIN(STREAM_BAND_ROWS, last - band);
+    uint32_t offset = sizeof(PbiHeader) + band * bitmap->row_size;
+    bytes_read += resource_load_byte_range(bitmap->handle, offset, bitmap->band,
+                                           rows * bitmap->row_size);
+    
+    for(int y = 0; y < rows; y++)
+    {
+      const uint8_t *src = bitmap->band + y * bitmap->row_size;
+      GBitmapDataRowInfo row = gbitmap_get_data_row_info(frame_buffer, origin.y + band + y);
+      int x_first = MAX(0, row.min_x - origin.x);
+      int x_last = MIN(bitmap->size.w - 1, row.max_x - origin.x);
+      for(int x = x_first; x <= x_last; x++)
+      {
+        uint8_t color = stream_pixel(bitmap, src, x);
+#if defined(PBL_COLOR)
+        row.data[origin.x + x] = color;
+#else
+        int dst_x = origin.x + x;
+        if(color == GColorWhiteARGB8)
+        {
+          row.data[dst_x >> 3] |= 1 << (dst_x & 7);
+        }
+        else
+        {
+          row.data[dst_x >> 3] &= ~(1 << (dst_x & 7));
+        }
+#endif
+      }
+    }
+  }
+  
+  graphics_release_frame_buffer(ctx, frame_buffer);
+  return bytes_read;
+}
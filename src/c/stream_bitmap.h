@@ -0,0 +1,21 @@
+#pragma once
+#include <pebble.h>
+
+/*
+A streamed bitmap draws a PBI bitmap resource a band of rows at a time,
+reading each band with resource_load_byte_range into one small buffer,
+instead of keeping the whole decoded bitmap in the heap. Only the header
+and palette stay resident between draws.
+*/
+
+//Rows read from the resource per resource_load_byte_range call
+#ifndef STREAM_BAND_ROWS
+#define STREAM_BAND_ROWS 8
+#endif
+
+typedef struct StreamBitmap StreamBitmap;
+
+StreamBitmap *stream_bitmap_open(uint32_t resource_id);
+void stream_bitmap_close(StreamBitmap *bitmap);
+GSize stream_bitmap_get_size(const StreamBitmap *bitmap);
+size_t stream_bitmap_draw(GContext *ctx, StreamBitmap *bitmap, GPoint origin);
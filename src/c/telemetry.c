@@ -0,0 +1,96 @@
+#include <pebble.h>
+#include "telemetry.h"
+#include "scheduler.h"
+
+/*
+The code in this file records telemetry (battery level, connection
+events, handler timings and dropped message reasons) as fixed-size
+binary records and hands them to the Data Logging service in batches.
+The firmware stores them and flushes them to the phone whenever it is
+convenient, so no AppMessage traffic is spent on metrics.
+*/
+
+//Records are collected in RAM and logged this many at a time
+#define TELEMETRY_BATCH_SIZE 8
+
+static DataLoggingSessionRef s_session;
+static TelemetryRecord s_batch[TELEMETRY_BATCH_SIZE];
+static int s_batch_count;
+
+/*
+telemetry_flush takes no arguments
+Function hands the batched records to Data Logging in one call
+*/
+static void telemetry_flush(void)
+{
+  if(s_session && s_batch_count > 0)
+  {
+    data_logging_log(s_session, s_batch, s_batch_count);
+  }
+  s_batch_count = 0;
+}
+
+/*
+telemetry_init takes no arguments
+Function opens the Data Logging session. It is resumed rather than
+  recreated if the face was running before
+*/
+void telemetry_init(void)
+{
+  s_session = data_logging_create(TELEMETRY_TAG, DATA_LOGGING_BYTE_ARRAY,
+                                  sizeof(TelemetryRecord), true);
+}
+
+/*
+telemetry_deinit takes no arguments
+Function logs any records still batched and closes the session
+*/
+void telemetry_deinit(void)
+{
+  telemetry_flush();
+  if(s_session)
+  {
+    data_logging_finish(s_session);
+    s_session = NULL;
+  }
+}
+
+/*
+telemetry_log takes 3 arguments: the kind of record, a type-specific
+  detail byte and the value
+Function adds a timestamped record to the batch, logging the batch once
+  it is full
+*/
+void telemetry_log(TelemetryType type, uint8_t detail, uint16_t value)
+{
+  TelemetryRecord *record = &s_batch[s_batch_count++];
+  record->timestamp = (uint32_t)time(NULL);
+  record->value = value;
+  record->type = (uint8_t)type;
+  record->detail = detail;
+  
+  if(s_batch_count == TELEMETRY_BATCH_SIZE)
+  {
+    telemetry_flush();
+  }
+}
+
+/*
+telemetry_timer_start takes no arguments
+Function returns a start time to pass to telemetry_timer_stop
+*/
+uint32_t telemetry_timer_start(void)
+{
+  return scheduler_now_ms();
+}
+
+/*
+telemetry_timer_stop takes 2 arguments: the handler being timed and the
+  value telemetry_timer_start returned when it began
+Function records how many milliseconds the handler took
+*/
+void telemetry_timer_stop(TelemetryHandler handler, uint32_t start)
+{
+  uint32_t elapsed = scheduler_now_ms() - start;
+  telemetry_log(TELEMETRY_HANDLER_TIME, (uint8_t)handler, (uint16_t)MIN(elapsed, 0xFFFF));
+}
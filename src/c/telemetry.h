@@ -0,0 +1,41 @@
+#pragma once
+#include <pebble.h>
+
+//Data Logging tag the face's telemetry session is created with
+#define TELEMETRY_TAG 0x54454C45
+
+//Kinds of telemetry record
+typedef enum
+{
+  TELEMETRY_BATTERY = 1,
+  TELEMETRY_CONNECTION = 2,
+  TELEMETRY_HANDLER_TIME = 3,
+  TELEMETRY_MESSAGE_DROPPED = 4,
+} TelemetryType;
+
+//What a TELEMETRY_HANDLER_TIME record timed (its detail byte); the first
+//frame record is the time from main() to the first frame drawn, and the
+//background stream record is the mean resource read and copy time per
+//redraw over the last minute (STREAM_BACKGROUND builds only)
+typedef enum
+{
+  TELEMETRY_TICK_HANDLER = 1,
+  TELEMETRY_INBOX_RECEIVED = 2,
+  TELEMETRY_FIRST_FRAME = 3,
+  TELEMETRY_BACKGROUND_STREAM = 4,
+} TelemetryHandler;
+
+//One fixed-size telemetry record, 8 bytes (little endian)
+typedef struct
+{
+  uint32_t timestamp;
+  uint16_t value;
+  uint8_t type;
+  uint8_t detail;
+} TelemetryRecord;
+
+void telemetry_init(void);
+void telemetry_deinit(void);
+void telemetry_log(TelemetryType type, uint8_t detail, uint16_t value);
+uint32_t telemetry_timer_start(void);
+void telemetry_timer_stop(TelemetryHandler handler, uint32_t start);
@@ -0,0 +1,88 @@
+#include <pebble.h>
+#include "theme.h"
+
+/*
+The code in this file holds the theme table and recolors palettes.
+*/
+
+//The first theme is the face's original black and white look
+static const Theme s_themes[] =
+{
+  { {.argb = GColorBlackARGB8}, {.argb = GColorWhiteARGB8}, {.argb = GColorWhiteARGB8} },
+#if defined(PBL_COLOR)
+  { {.argb = GColorOxfordBlueARGB8}, {.argb = GColorCelesteARGB8}, {.argb = GColorVividCeruleanARGB8} },
+  { {.argb = GColorBulgarianRoseARGB8}, {.argb = GColorRajahARGB8}, {.argb = GColorOrangeARGB8} },
+  { {.argb = GColorDarkGreenARGB8}, {.argb = GColorMintGreenARGB8}, {.argb = GColorGreenARGB8} },
+#endif
+};
+
+/*
+theme_count takes no arguments
+Function returns how many themes there are
+*/
+int theme_count(void)
+{
+  return ARRAY_LENGTH(s_themes);
+}
+
+/*
+theme_get takes 1 argument: a theme index
+Function returns the theme, or the first theme if the index is out of range
+*/
+const Theme *theme_get(int index)
+{
+  if(index < 0 || index >= theme_count())
+  {
+    index = 0;
+  }
+  return &s_themes[index];
+}
+
+/*
+theme_palette_attach takes 3 arguments: the palette storage, a bitmap just
+  loaded from resources (NULL if it failed to load) and the theme to draw
+  it in
+Function keeps the bitmap's loaded palette and points the bitmap at a
+  recolored copy. Bitmaps that are not palettized are left as they are
+*/
+void theme_palette_attach(ThemePalette *palette, GBitmap *bitmap, const Theme *theme)
+{
+  if(!bitmap)
+  {
+    palette->count = 0;
+    return;
+  }
+  
+  switch(gbitmap_get_format(bitmap))
+  {
+    case GBitmapFormat1BitPalette: palette->count = 2; break;
+    case GBitmapFormat2BitPalette: palette->count = 4; break;
+    case GBitmapFormat4BitPalette: palette->count = 16; break;
+    default: palette->count = 0; return;
+  }
+  
+  memcpy(palette->original, gbitmap_get_palette(bitmap), palette->count * sizeof(GColor));
+  theme_palette_update(palette, theme);
+  gbitmap_set_palette(bitmap, palette->themed, false);
+}
+
+/*
+theme_palette_update takes 2 arguments: an attached palette and a theme
+Function recolors the palette in place for the theme: light entries become
+  the theme's ink, dark ones its paper and transparent ones stay clear
+*/
+void theme_palette_update(ThemePalette *palette, const Theme *theme)
+{
+  for(int i = 0; i < palette->count; i++)
+  {
+    GColor color = palette->original[i];
+    if(color.a == 0)
+    {
+      palette->themed[i] = color;
+    }
+    else
+    {
+      palette->themed[i] = color.r + color.g + color.b > 4 ? theme->ink : theme->paper;
+    }
+  }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <pebble.h>
+
+/*
+Themes recolor the face from one set of black and white assets. Each
+theme names the colors that stand in for black and white, and palettized
+bitmaps are recolored by pointing them at a remapped copy of the palette
+they were loaded with, so no asset is duplicated per theme.
+*/
+
+//Most palette entries a bitmap can have and still be recolored (4-bit)
+#define THEME_MAX_COLORS 16
+
+typedef struct
+{
+  GColor paper;  //stands in for black: window, date bar, battery track, time text
+  GColor ink;    //stands in for white: background art, date and weather text
+  GColor accent; //battery level
+} Theme;
+
+//A bitmap's palette as loaded, and the themed copy the bitmap draws with
+typedef struct
+{
+  GColor original[THEME_MAX_COLORS];
+  GColor themed[THEME_MAX_COLORS];
+  uint8_t count;
+} ThemePalette;
+
+int theme_count(void);
+const Theme *theme_get(int index);
+void theme_palette_attach(ThemePalette *palette, GBitmap *bitmap, const Theme *theme);
+void theme_palette_update(ThemePalette *palette, const Theme *theme);
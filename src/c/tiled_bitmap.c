@@ -0,0 +1,181 @@
+#include <pebble.h>
+#include "tiled_bitmap.h"
+#include "event_log.h"
+
+/*
+The code in this file loads tiled bitmaps and draws them into the frame
+buffer.
+*/
+
+//Layout of the tiles resource written by tools/tiles.py; the tiles follow
+typedef struct
+{
+  uint8_t tile_size;
+  uint8_t bits_per_pixel;
+  uint16_t tile_count;
+  uint8_t palette[16];
+  uint8_t data[];
+} TileSet;
+
+//Layout of the tile map resource; one tile index per cell follows
+typedef struct
+{
+  uint16_t width;
+  uint16_t height;
+  uint8_t columns;
+  uint8_t rows;
+  uint8_t cells[];
+} TileMap;
+
+struct TiledBitmap
+{
+  TileSet *tiles;
+  TileMap *map;
+  uint16_t tile_bytes;
+  uint8_t row_bytes;
+};
+
+/*
+tiled_bitmap_load_resource takes 1 argument: a resource ID
+Function loads the whole resource into the heap, returning NULL if the
+  memory is not available
+*/
+static void *tiled_bitmap_load_resource(uint32_t resource_id)
+{
+  ResHandle handle = resource_get_handle(resource_id);
+  size_t size = resource_size(handle);
+  void *data = malloc(size);
+  if(data)
+  {
+    resource_load(handle, data, size);
+  }
+  return data;
+}
+
+/*
+tiled_bitmap_load takes 2 arguments: the tiles and tile map resource IDs
+Function loads both resources, returning NULL if either cannot be loaded
+*/
+TiledBitmap *tiled_bitmap_load(uint32_t tiles_id, uint32_t map_id)
+{
+  TiledBitmap *bitmap = malloc(sizeof(TiledBitmap));
+  if(!bitmap)
+  {
+    return NULL;
+  }
+  bitmap->tiles = tiled_bitmap_load_resource(tiles_id);
+  bitmap->map = tiled_bitmap_load_resource(map_id);
+  if(!bitmap->tiles || !bitmap->map)
+  {
+    tiled_bitmap_destroy(bitmap);
+    return NULL;
+  }
+  
+  bitmap->row_bytes = (bitmap->tiles->tile_size * bitmap->tiles->bits_per_pixel + 7) / 8;
+  bitmap->tile_bytes = bitmap->row_bytes * bitmap->tiles->tile_size;
+  LOG_DEBUG("Loaded %d tiles for %d cells", bitmap->tiles->tile_count,
+            bitmap->map->columns * bitmap->map->rows);
+  return bitmap;
+}
+
+/*
+tiled_bitmap_destroy takes 1 argument: a bitmap from tiled_bitmap_load
+Function frees the bitmap and its tiles
+*/
+void tiled_bitmap_destroy(TiledBitmap *bitmap)
+{
+  free(bitmap->tiles);
+  free(bitmap->map);
+  free(bitmap);
+}
+
+/*
+tiled_bitmap_get_size takes 1 argument: the bitmap
+Function returns the size of the whole image in pixels
+*/
+GSize tiled_bitmap_get_size(const TiledBitmap *bitmap)
+{
+  return GSize(bitmap->map->width, bitmap->map->height);
+}
+
+/*
+tiled_bitmap_pixel takes 3 arguments: the bitmap, a tile row and x
+Function returns the GColor8 value of the pixel at x in the row
+*/
+static uint8_t tiled_bitmap_pixel(const TiledBitmap *bitmap, const uint8_t *row, int x)
+{
+  int bpp = bitmap->tiles->bits_per_pixel;
+  if(bpp == 8)
+  {
+    return row[x];
+  }
+  int per_byte = 8 / bpp;
+  int shift = 8 - bpp * (x % per_byte + 1);
+  return bitmap->tiles->palette[(row[x / per_byte] >> shift) & ((1 << bpp) - 1)];
+}
+
+/*
+tiled_bitmap_draw takes 3 arguments: the graphics context, the bitmap and
+  the screen position of its top left corner
+Function copies the part of the image on the screen into the frame
+  buffer, a tile at a time, and returns how many tiles it touched
+*/
+int tiled_bitmap_draw(GContext *ctx, const TiledBitmap *bitmap, GPoint origin)
+{
+  GBitmap *frame_buffer = graphics_capture_frame_buffer(ctx);
+  if(!frame_buffer)
+  {
+    return 0;
+  }
+  
+  //Clip to the screen, in image coordinates
+  GSize screen = gbitmap_get_bounds(frame_buffer).size;
+  int x0 = MAX(-origin.x, 0);
+  int y0 = MAX(-origin.y, 0);
+  int x1 = MIN(screen.w - origin.x, bitmap->map->width);
+  int y1 = MIN(screen.h - origin.y, bitmap->map->height);
+  if(x0 >= x1 || y0 >= y1)
+  {
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    return 0;
+  }
+  
+  int size = bitmap->tiles->tile_size;
+  int drawn = 0;
+  for(int ty = y0 / size; ty * size < y1; ty++)
+  {
+    for(int tx = x0 / size; tx * size < x1; tx++, drawn++)
+    {
+      const uint8_t *tile = bitmap->tiles->data +
+        bitmap->map->cells[ty * bitmap->map->columns + tx] * bitmap->tile_bytes;
+      int left = MAX(x0, tx * size), right = MIN(x1, (tx + 1) * size);
+      int top = MAX(y0, ty * size), bottom = MIN(y1, (ty + 1) * size);
+      
+      for(int y = top; y < bottom; y++)
+      {
+        const uint8_t *src = tile + (y - ty * size) * bitmap->row_bytes;
+        uint8_t *dst = gbitmap_get_data_row_info(frame_buffer, origin.y + y).data;
+        for(int x = left; x < right; x++)
+        {
+          uint8_t color = tiled_bitmap_pixel(bitmap, src, x - tx * size);
+          int dst_x = origin.x + x;
+#if defined(PBL_COLOR)
+          dst[dst_x] = color;
+#else
+          if(color == GColorWhiteARGB8)
+          {
+            dst[dst_x >> 3] |= 1 << (dst_x & 7);
+          }
+          else
+          {
+            dst[dst_x >> 3] &= ~(1 << (dst_x & 7));
+          }
+#endif
+        }
+      }
+    }
+  }
+  
+  graphics_release_frame_buffer(ctx, frame_buffer);
+  return drawn;
+}
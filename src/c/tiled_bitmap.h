@@ -0,0 +1,16 @@
+#pragma once
+#include <pebble.h>
+
+/*
+A tiled bitmap is an image split ahead of time (see tools/tiles.py) into
+square tiles, each distinct tile stored once, plus a map of which tile
+goes in each cell. Drawing copies the tiles straight into the frame
+buffer, skipping any part of the image that is off the screen.
+*/
+
+typedef struct TiledBitmap TiledBitmap;
+
+TiledBitmap *tiled_bitmap_load(uint32_t tiles_id, uint32_t map_id);
+void tiled_bitmap_destroy(TiledBitmap *bitmap);
+GSize tiled_bitmap_get_size(const TiledBitmap *bitmap);
+int tiled_bitmap_draw(GContext *ctx, const TiledBitmap *bitmap, GPoint origin);
@@ -0,0 +1,79 @@
+#include <pebble.h>
+#include "vector_icon.h"
+
+/*
+The code in this file loads draw command images and rewrites their
+commands in place.
+*/
+
+//Scale factors from the image's view box to the size it is drawn at
+typedef struct
+{
+  GSize from;
+  GSize to;
+} VectorIconScale;
+
+/*
+vector_icon_scale_command takes 3 arguments: a draw command, its index
+  (unused) and the VectorIconScale
+Function scales the command's points and stroke width
+*/
+static bool vector_icon_scale_command(GDrawCommand *command, uint32_t index, void *context)
+{
+  VectorIconScale *scale = context;
+  for(uint16_t i = 0; i < gdraw_command_get_num_points(command); i++)
+  {
+    GPoint point = gdraw_command_get_point(command, i);
+    point.x = point.x * scale->to.w / scale->from.w;
+    point.y = point.y * scale->to.h / scale->from.h;
+    gdraw_command_set_point(command, i, point);
+  }
+  int width = gdraw_command_get_stroke_width(command) * scale->to.w / scale->from.w;
+  gdraw_command_set_stroke_width(command, MAX(width, 1));
+  return true;
+}
+
+/*
+vector_icon_load takes 2 arguments: the PDC resource ID and the size to
+  draw the icon at
+Function loads the image and scales it from its view box to the size,
+  returning NULL if it cannot be loaded
+*/
+GDrawCommandImage *vector_icon_load(uint32_t resource_id, GSize size)
+{
+  GDrawCommandImage *image = gdraw_command_image_create_with_resource(resource_id);
+  if(!image)
+  {
+    return NULL;
+  }
+  
+  VectorIconScale scale = { .from = gdraw_command_image_get_bounds_size(image), .to = size };
+  if(scale.from.w != size.w || scale.from.h != size.h)
+  {
+    gdraw_command_list_iterate(gdraw_command_image_get_command_list(image),
+                               vector_icon_scale_command, &scale);
+    gdraw_command_image_set_bounds_size(image, size);
+  }
+  return image;
+}
+
+/*
+vector_icon_set_command_color takes 3 arguments: a draw command, its index
+  (unused) and the GColor to stroke with
+Function sets the command's stroke color
+*/
+static bool vector_icon_set_command_color(GDrawCommand *command, uint32_t index, void *context)
+{
+  gdraw_command_set_stroke_color(command, *(GColor *)context);
+  return true;
+}
+
+/*
+vector_icon_set_color takes 2 arguments: the image and a color
+Function strokes every command of the image in the color
+*/
+void vector_icon_set_color(GDrawCommandImage *image, GColor color)
+{
+  gdraw_command_list_iterate(gdraw_command_image_get_command_list(image),
+                             vector_icon_set_command_color, &color);
+}
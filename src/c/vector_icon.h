@@ -0,0 +1,11 @@
+#pragma once
+#include <pebble.h>
+
+/*
+Vector icons are Pebble Draw Command images (see tools/pdc.py) scaled
+once at load time to the size they are drawn at, so one resource serves
+every screen size.
+*/
+
+GDrawCommandImage *vector_icon_load(uint32_t resource_id, GSize size);
+void vector_icon_set_color(GDrawCommandImage *image, GColor color);
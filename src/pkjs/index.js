@@ -41,11 +41,15 @@ function locationSuccess(pos)
       var conditions = json.weather[0].main;
       console.log('Conditions are ' + conditions);
       
+      //Condition code, which picks the icon on the watch
+      var weatherIcon = json.weather[0].id;
+      
       //Assemble dictionary using our keys
       var dictionary = 
       {
         "TEMPERATURE": temperature,
-        "CONDITIONS": conditions
+        "CONDITIONS": conditions,
+        "WEATHER_ICON": weatherIcon
       };
       
       //Send to Pebble
@@ -88,11 +92,106 @@ Pebble.addEventListener('ready',
   }
 );
 
+//Names for the watch's event log codes (see src/c/event_log.h)
+var eventNames =
+{
+  1: 'inbox dropped',
+  2: 'outbox failed',
+  3: 'BT blip debounced',
+  4: 'BT vibe limited'
+};
+
+//Print a chunk of 8-byte event log records sent by the watch
+function printLogRecords(bytes)
+{
+  for(var i = 0; i + 8 <= bytes.length; i += 8)
+  {
+    var timestamp = (bytes[i] | (bytes[i + 1] << 8) | (bytes[i + 2] << 16) | (bytes[i + 3] << 24)) >>> 0;
+    var reason = bytes[i + 4] | (bytes[i + 5] << 8);
+    var code = bytes[i + 6];
+    console.log('Event ' + new Date(timestamp * 1000).toISOString() + ' ' +
+                (eventNames[code] || code) + ' (' + reason + ')');
+  }
+}
+
 //Listen for when an AppMessage is received
 Pebble.addEventListener('appMessage',
   function(e)
   {
     console.log('AppMessage received!');
+    
+    //Event log chunks are printed, anything else is a weather request
+    if(e.payload.LOG_RECORDS)
+    {
+      printLogRecords(e.payload.LOG_RECORDS);
+      return;
+    }
     getWeather();
   }
+);
+
+//Theme names in the order of the table in src/c/theme.c; black and white
+//watches only have the first, and ignore the other indices
+var themeNames = ['Black and white', 'Oxford blue', 'Bulgarian rose', 'Dark green'];
+
+//Build the settings page: a theme picker, and a box to ask for the watch's
+//event log, which is only sent over the radio when ticked
+function configPage(selected)
+{
+  var options = themeNames.map(function(name, index)
+  {
+    return '<option value="' + index + '"' + (index == selected ? ' selected' : '') + '>' +
+           name + '</option>';
+  }).join('');
+  return 'data:text/html,' + encodeURIComponent(
+    '<!DOCTYPE html><html><head><meta name="viewport" content="width=device-width"></head>' +
+    '<body><h3>Theme</h3><select id="theme">' + options + '</select>' +
+    '<h3>Diagnostics</h3><label><input type="checkbox" id="dumpLog"> Dump the event log</label>' +
+    '<p><button onclick="location.href=\'pebblejs://close#\' + encodeURIComponent(JSON.stringify(' +
+    '{theme: +document.getElementById(\'theme\').value, ' +
+    'dumpLog: document.getElementById(\'dumpLog\').checked}))">Save</button></p></body></html>');
+}
+
+//Opening the face's settings in the Pebble app shows the settings page
+Pebble.addEventListener('showConfiguration',
+  function(e)
+  {
+    Pebble.openURL(configPage(localStorage.getItem('theme') || 0));
+  }
+);
+
+//Send the settings saved in the page: the theme, which the watch saves,
+//and a log dump request if one was ticked
+Pebble.addEventListener('webviewclosed',
+  function(e)
+  {
+    var settings;
+    try
+    {
+      settings = JSON.parse(decodeURIComponent(e.response || ''));
+    }
+    catch(error)
+    {
+      //Closed without saving
+      return;
+    }
+    
+    var dictionary = { "THEME": settings.theme };
+    localStorage.setItem('theme', settings.theme);
+    if(settings.dumpLog)
+    {
+      console.log('Requesting event log from the watch');
+      dictionary.LOG_DUMP = 1;
+    }
+    Pebble.sendAppMessage(dictionary,
+      function(e)
+      {
+        console.log('Settings sent to Pebble successfully!');
+      },
+      function(e)
+      {
+        console.log('Error sending settings to Pebble!');
+      }
+    );
+  }
 );
\ No newline at end of file
@@ -0,0 +1,171 @@
+#
+# Bitmap asset analysis for the wscript build.
+#
+# Decodes each bitmap resource's PNG (stdlib only, so it runs wherever the
+# Pebble SDK does), counts the colours that survive Pebble's 2-bit-per-channel
+# quantization and works out the smallest GBitmapFormat that holds the image
+# losslessly, along with what it costs in the resource pack and on the heap.
+#
+
+import struct
+import zlib
+
+# Palettized formats by bits per pixel; the SDK picks the same one for
+# "memoryFormat": "SmallestPalette"
+PALETTE_FORMATS = [(1, '1BitPalette'), (2, '2BitPalette'), (4, '4BitPalette')]
+
+# Size of the GBitmap header the firmware allocates next to the pixel data
+GBITMAP_HEADER_BYTES = 20
+# Size of the PBI header stored in front of the pixels in the resource pack
+PBI_HEADER_BYTES = 12
+
+
+def _paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(path):
+    """Returns (width, height, rows) where rows are lists of (r, g, b, a)."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('{} is not a PNG'.format(path))
+
+    pos = 8
+    idat = b''
+    palette = []
+    trns = b''
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, colour, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'PLTE':
+            palette = [tuple(bytearray(chunk[i:i + 3])) for i in range(0, length, 3)]
+        elif kind == b'tRNS':
+            trns = bytearray(chunk)
+        elif kind == b'IDAT':
+            idat += chunk
+        elif kind == b'IEND':
+            break
+
+    if interlace or depth == 16:
+        raise ValueError('{}: interlaced and 16-bit PNGs are not supported'.format(path))
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[colour]
+    bpp = max(1, channels * depth // 8)
+    stride = (width * channels * depth + 7) // 8
+    raw = bytearray(zlib.decompress(idat))
+
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        kind = raw[start]
+        line = raw[start + 1:start + 1 + stride]
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif kind == 4:
+                line[i] = (line[i] + _paeth(a, b, c)) & 0xFF
+        prev = line
+
+        if depth < 8:
+            per_byte = 8 // depth
+            mask = (1 << depth) - 1
+            samples = [(line[x // per_byte] >> (8 - depth * (x % per_byte + 1))) & mask
+                       for x in range(width)]
+        else:
+            samples = list(line)
+
+        pixels = []
+        for x in range(width):
+            if colour == 3:
+                index = samples[x]
+                r, g, b = palette[index]
+                pixels.append((r, g, b, trns[index] if index < len(trns) else 255))
+            elif colour == 0:
+                v = samples[x] * 255 // ((1 << depth) - 1)
+                pixels.append((v, v, v, 255))
+            elif colour == 4:
+                v, a = samples[2 * x:2 * x + 2]
+                pixels.append((v, v, v, a))
+            elif colour == 2:
+                pixels.append(tuple(samples[3 * x:3 * x + 3]) + (255,))
+            else:
+                pixels.append(tuple(samples[4 * x:4 * x + 4]))
+        rows.append(pixels)
+
+    return width, height, rows
+
+
+def pebble_colours(rows):
+    """Returns the set of distinct Pebble (2 bits per channel) colours."""
+    colours = set()
+    for row in rows:
+        for r, g, b, a in row:
+            a >>= 6
+            colours.add((0, 0, 0, 0) if a == 0 else (r >> 6, g >> 6, b >> 6, a))
+    return colours
+
+
+def smallest_format(count, platform):
+    """Returns (format name, bits per pixel) for count colours on platform."""
+    if platform == 'aplite':
+        return '1Bit', 1
+    for bits, name in PALETTE_FORMATS:
+        if count <= 1 << bits:
+            return name, bits
+    return '8Bit', 8
+
+
+def analyse(path, platform):
+    """Returns a dict describing how the bitmap at path packs on platform."""
+    width, height, rows = read_png(path)
+    count = len(pebble_colours(rows))
+    name, bits = smallest_format(count, platform)
+    if name == '1Bit':
+        # 1-bit rows are word aligned and unpalettized
+        row_bytes = (width + 31) // 32 * 4
+        palette_bytes = 0
+    else:
+        row_bytes = (width * bits + 7) // 8
+        palette_bytes = (1 << bits) if bits < 8 else 0
+    pixel_bytes = row_bytes * height
+    with open(path, 'rb') as f:
+        png_bytes = len(f.read())
+    return {
+        'width': width,
+        'height': height,
+        'colours': count,
+        'format': name,
+        'png_bytes': png_bytes,
+        'packed_bytes': PBI_HEADER_BYTES + pixel_bytes + palette_bytes,
+        'heap_bytes': GBITMAP_HEADER_BYTES + pixel_bytes + palette_bytes,
+    }
+
+
+def report_lines(resources, platforms):
+    """Returns the size report table for (name, path) resources as lines."""
+    lines = ['{:<18} {:<8} {:>7} {:>6} {:<12} {:>6} {:>7} {:>6}'.format(
+        'resource', 'platform', 'size', 'colors', 'format', 'png', 'packed', 'heap')]
+    for platform in platforms:
+        for name, path in resources:
+            info = analyse(path, platform)
+            lines.append('{:<18} {:<8} {:>7} {:>6} {:<12} {:>6} {:>7} {:>6}'.format(
+                name, platform, '{}x{}'.format(info['width'], info['height']),
+                info['colours'], info['format'], info['png_bytes'],
+                info['packed_bytes'], info['heap_bytes']))
+    return lines
@@ -0,0 +1,112 @@
+#
+# Binary size and RAM budget report for the wscript build.
+#
+# Reads pebble-app.elf with the toolchain's nm and size, writes a per-symbol
+# size map next to it, and summarizes where the bytes go (our code, printf and
+# strftime support, soft-float helpers, everything else) against the
+# platform's app size limit.
+#
+
+import re
+import subprocess
+
+# Most code + data + bss an app may use on each platform
+APP_LIMITS = {
+    'aplite': 24 * 1024,
+    'basalt': 64 * 1024,
+    'chalk': 64 * 1024,
+    'diorite': 64 * 1024,
+    'emery': 128 * 1024,
+}
+
+# Symbol groups reported separately, checked in order
+GROUPS = [
+    ('printf', re.compile(r'printf|_dtoa|__sprint|__ssprint|_svfi?printf|_vfi?printf')),
+    ('strftime', re.compile(r'strftime|__tzcalc|_tzset|__get_current_time_locale')),
+    ('soft-float', re.compile(r'^__(aeabi_[dfl]|add[sd]f|sub[sd]f|mul[sd]f|div[sd]f|fix|float|'
+                              r'cmp[sd]f|eq[sd]f|ne[sd]f|lt[sd]f|le[sd]f|gt[sd]f|ge[sd]f|'
+                              r'unord[sd]f|extendsfdf|truncdfsf|clz)')),
+]
+
+# nm symbol types by section; lowercase is the local form
+SECTION_OF_TYPE = {'t': 'text', 'r': 'text', 'd': 'data', 'b': 'bss'}
+
+
+def _run(args):
+    return subprocess.check_output(args).decode('utf-8', 'replace')
+
+
+def tool_path(cc, name):
+    """Returns the path of binutils tool name next to the C compiler cc."""
+    return re.sub(r'gcc(\.exe)?$', name, cc)
+
+
+def symbols(nm, path):
+    """Returns [(name, size, section)] for the sized symbols in path."""
+    result = []
+    for line in _run([nm, '--print-size', '--size-sort', path]).splitlines():
+        parts = line.split()
+        if len(parts) != 4:
+            continue
+        section = SECTION_OF_TYPE.get(parts[2].lower())
+        if section:
+            result.append((parts[3], int(parts[1], 16), section))
+    return result
+
+
+def defined_names(nm, objects):
+    """Returns the names of the symbols defined in our own object files."""
+    names = set()
+    for path in objects:
+        for line in _run([nm, '--defined-only', path]).splitlines():
+            parts = line.split()
+            if len(parts) == 3:
+                names.add(parts[2])
+    return names
+
+
+def sections(size, path):
+    """Returns (text, data, bss) from the size tool's Berkeley output."""
+    fields = _run([size, path]).splitlines()[1].split()
+    return int(fields[0]), int(fields[1]), int(fields[2])
+
+
+def group_of(name, own):
+    for group, pattern in GROUPS:
+        if pattern.search(name):
+            return group
+    return 'app' if name in own else 'other'
+
+
+def report(cc, elf, objects, map_path, platform, budget):
+    """Writes the symbol map and returns (lines, error or None)."""
+    nm = tool_path(cc, 'nm')
+    syms = symbols(nm, elf)
+    own = defined_names(nm, objects)
+
+    totals = {}
+    with open(map_path, 'w') as f:
+        f.write('{:>7}  {:<5} {:<10} {}\n'.format('bytes', 'sect', 'group', 'symbol'))
+        for name, sym_size, section in reversed(syms):
+            group = group_of(name, own)
+            totals[group] = totals.get(group, 0) + sym_size
+            f.write('{:>7}  {:<5} {:<10} {}\n'.format(sym_size, section, group, name))
+
+    text, data, bss = sections(tool_path(cc, 'size'), elf)
+    used = text + data + bss
+    limit = APP_LIMITS.get(platform)
+    lines = [
+        'text {} + data {} = {} bytes of flash, + bss {} = {} bytes of app RAM{}'.format(
+            text, data, text + data, bss, used,
+            ' ({:.0f}% of {})'.format(100.0 * used / limit, limit) if limit else ''),
+        'by group: ' + ', '.join('{} {}'.format(group, totals[group])
+                                 for group in sorted(totals, key=totals.get, reverse=True)),
+        'symbol map: ' + map_path,
+    ]
+
+    error = None
+    if budget and used > budget:
+        error = '{}: app uses {} bytes, over the {} byte budget'.format(platform, used, budget)
+    elif limit and used > limit:
+        error = '{}: app uses {} bytes, over the platform limit of {}'.format(platform, used, limit)
+    return lines, error
@@ -0,0 +1,221 @@
+#
+# Pre-rasterized glyph strips for the monospace text renderer.
+#
+# Rasterizes the printable ASCII glyphs of a TrueType font at a given pixel
+# size (stdlib only: a minimal TrueType reader plus a point-sampling
+# rasterizer) and writes them as a raw resource the watch can blit directly:
+#
+#   header: first char, glyph count, glyph width, glyph height, bytes per row
+#   glyphs: count * height rows of (bytes per row) bytes, leftmost pixel in
+#           bit 0 of the first byte, as src/c/blit.h expects
+#
+# The strip is committed with the other resources. After changing the font or
+# this script, regenerate it from the repository root:
+#
+#   python tools/glyphs.py "resources/fonts/Perfect DOS VGA 437.ttf" 18 resources/data/dos18_glyphs.bin
+#
+
+import struct
+import sys
+
+FIRST_CHAR = 32
+LAST_CHAR = 126
+
+
+class TrueType(object):
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        count = struct.unpack('>H', self.data[4:6])[0]
+        self.tables = {}
+        for i in range(count):
+            tag, _, offset, length = struct.unpack('>4sIII', self.data[12 + 16 * i:28 + 16 * i])
+            self.tables[tag.decode('latin-1')] = (offset, length)
+
+        head = self.tables['head'][0]
+        self.units_per_em = self._u16(head + 18)
+        self.long_loca = self._s16(head + 50) == 1
+        hhea = self.tables['hhea'][0]
+        self.ascender = self._s16(hhea + 4)
+        self.descender = self._s16(hhea + 6)
+        self.metric_count = self._u16(hhea + 34)
+        self.cmap = self._read_cmap()
+
+    def _u16(self, pos):
+        return struct.unpack('>H', self.data[pos:pos + 2])[0]
+
+    def _s16(self, pos):
+        return struct.unpack('>h', self.data[pos:pos + 2])[0]
+
+    def _read_cmap(self):
+        base = self.tables['cmap'][0]
+        for i in range(self._u16(base + 2)):
+            platform, encoding, offset = struct.unpack('>HHI', self.data[base + 4 + 8 * i:base + 12 + 8 * i])
+            table = base + offset
+            if self._u16(table) == 4 and (platform, encoding) in ((3, 1), (0, 3), (3, 0)):
+                return self._read_cmap4(table)
+        raise ValueError('no supported cmap subtable')
+
+    def _read_cmap4(self, table):
+        segments = self._u16(table + 6) // 2
+        ends = table + 14
+        starts = ends + 2 * segments + 2
+        deltas = starts + 2 * segments
+        ranges = deltas + 2 * segments
+        mapping = {}
+        for s in range(segments):
+            end, start = self._u16(ends + 2 * s), self._u16(starts + 2 * s)
+            delta, range_offset = self._u16(deltas + 2 * s), self._u16(ranges + 2 * s)
+            for code in range(start, min(end, 0xFFFE) + 1):
+                if range_offset == 0:
+                    mapping[code] = (code + delta) & 0xFFFF
+                else:
+                    glyph = self._u16(ranges + 2 * s + range_offset + 2 * (code - start))
+                    mapping[code] = (glyph + delta) & 0xFFFF if glyph else 0
+        return mapping
+
+    def advance(self, glyph):
+        hmtx = self.tables['hmtx'][0]
+        return self._u16(hmtx + 4 * min(glyph, self.metric_count - 1))
+
+    def contours(self, glyph):
+        """Returns the glyph's outline as closed polygons of (x, y) points."""
+        loca = self.tables['loca'][0]
+        if self.long_loca:
+            start, end = struct.unpack('>II', self.data[loca + 4 * glyph:loca + 4 * glyph + 8])
+        else:
+            start, end = [2 * v for v in struct.unpack('>HH', self.data[loca + 2 * glyph:loca + 2 * glyph + 4])]
+        if start == end:
+            return []
+        pos = self.tables['glyf'][0] + start
+        count = self._s16(pos)
+        if count < 0:
+            raise ValueError('compound glyph {} is not supported'.format(glyph))
+
+        end_points = [self._u16(pos + 10 + 2 * i) for i in range(count)]
+        points = end_points[-1] + 1
+        pos += 10 + 2 * count
+        pos += 2 + self._u16(pos)
+
+        flags = []
+        while len(flags) < points:
+            flag = bytearray(self.data[pos:pos + 1])[0]
+            pos += 1
+            repeat = 1
+            if flag & 8:
+                repeat += bytearray(self.data[pos:pos + 1])[0]
+                pos += 1
+            flags.extend([flag] * repeat)
+
+        def coordinates(short_bit, same_bit):
+            values, value = [], 0
+            for flag in flags[:points]:
+                if flag & short_bit:
+                    step = bytearray(self.data[pos_box[0]:pos_box[0] + 1])[0]
+                    pos_box[0] += 1
+                    value += step if flag & same_bit else -step
+                elif not flag & same_bit:
+                    value += self._s16(pos_box[0])
+                    pos_box[0] += 2
+                values.append(value)
+            return values
+
+        pos_box = [pos]
+        xs = coordinates(2, 16)
+        ys = coordinates(4, 32)
+
+        polygons = []
+        first = 0
+        for last in end_points:
+            ring = [(xs[i], ys[i], flags[i] & 1) for i in range(first, last + 1)]
+            polygons.append(_flatten(ring))
+            first = last + 1
+        return polygons
+
+
+def _flatten(ring):
+    """Turns a TrueType contour (with quadratic off-curve points) into a polygon."""
+    count = len(ring)
+    # Start from an on-curve point, inventing one between two off-curve points
+    start = next((i for i, p in enumerate(ring) if p[2]), None)
+    if start is None:
+        a, b = ring[0], ring[1]
+        ring = [((a[0] + b[0]) / 2.0, (a[1] + b[1]) / 2.0, 1)] + ring[1:] + ring[:1]
+        start = 0
+    ring = ring[start:] + ring[:start]
+
+    polygon = [(ring[0][0], ring[0][1])]
+    control = None
+    for x, y, on_curve in ring[1:] + ring[:1]:
+        if on_curve:
+            if control:
+                polygon.extend(_quadratic(polygon[-1], control, (x, y)))
+                control = None
+            polygon.append((x, y))
+        else:
+            if control:
+                middle = ((control[0] + x) / 2.0, (control[1] + y) / 2.0)
+                polygon.extend(_quadratic(polygon[-1], control, middle))
+                polygon.append(middle)
+            control = (x, y)
+    return polygon
+
+
+def _quadratic(p0, p1, p2, steps=4):
+    return [((1 - t) ** 2 * p0[0] + 2 * (1 - t) * t * p1[0] + t * t * p2[0],
+             (1 - t) ** 2 * p0[1] + 2 * (1 - t) * t * p1[1] + t * t * p2[1])
+            for t in (i / float(steps) for i in range(1, steps))]
+
+
+def _inside(polygons, x, y):
+    winding = 0
+    for polygon in polygons:
+        for i in range(len(polygon)):
+            x0, y0 = polygon[i - 1]
+            x1, y1 = polygon[i]
+            if (y0 <= y) != (y1 <= y):
+                cross_x = x0 + (y - y0) * (x1 - x0) / float(y1 - y0)
+                if cross_x > x:
+                    winding += 1 if y1 > y0 else -1
+    return winding != 0
+
+
+def rasterize(font_path, pixel_size):
+    """Returns (width, height, row_bytes, glyphs) where glyphs holds each
+    character's rows as lists of bytes."""
+    font = TrueType(font_path)
+    scale = pixel_size / float(font.units_per_em)
+    width = int(round(font.advance(font.cmap.get(ord('0'), 0)) * scale))
+    height = int(round((font.ascender - font.descender) * scale))
+    row_bytes = (width + 7) // 8
+
+    glyphs = []
+    for code in range(FIRST_CHAR, LAST_CHAR + 1):
+        polygons = font.contours(font.cmap.get(code, 0))
+        rows = []
+        for py in range(height):
+            y = font.ascender - (py + 0.5) / scale
+            row = bytearray(row_bytes)
+            for px in range(width):
+                if polygons and _inside(polygons, (px + 0.5) / scale, y):
+                    row[px // 8] |= 1 << (px % 8)
+            rows.append(row)
+        glyphs.append(rows)
+    return width, height, row_bytes, glyphs
+
+
+def write_strip(font_path, pixel_size, out_path):
+    """Writes the glyph strip resource for the font at pixel_size."""
+    width, height, row_bytes, glyphs = rasterize(font_path, pixel_size)
+    with open(out_path, 'wb') as f:
+        f.write(struct.pack('<BBBBB', FIRST_CHAR, len(glyphs), width, height, row_bytes))
+        for rows in glyphs:
+            for row in rows:
+                f.write(bytes(row))
+    return width, height
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 4:
+        sys.exit('usage: glyphs.py FONT PIXEL_SIZE OUT')
+    write_strip(sys.argv[1], int(sys.argv[2]), sys.argv[3])
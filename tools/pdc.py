@@ -0,0 +1,76 @@
+#
+# Pebble Draw Command (PDC) icons.
+#
+# The face's icons are described below as vector paths, traced from their
+# PNGs onto the same view box, and encoded as PDCI resources that the watch
+# loads with gdraw_command_image_create_with_resource and scales to the
+# screen. The PDCI layout (little endian) is:
+#
+#   'PDCI', size of the rest (u32)
+#   image:    version (1), reserved, view box width and height (i16)
+#   commands: count (u16), then per command its type (1 = path), flags,
+#             stroke colour, stroke width, fill colour (GColor8), open path
+#             flag (u16), point count (u16) and points (i16 x, y)
+#
+# The encoded icons are committed with the other resources. After changing
+# an icon, regenerate it from the repository root:
+#
+#   python tools/pdc.py bt_icon resources/data/bt_icon.pdc
+#
+
+import struct
+import sys
+
+PDC_VERSION = 1
+PATH = 1
+CLEAR = 0x00
+WHITE = 0xFF
+
+# Paths are (points, open); a point is the top left pixel its 2 px stroke
+# covers in the PNG. The colours are the white the face's raster icons use,
+# which the watch swaps for the theme's ink
+ICONS = {
+    'bt_icon': {
+        'view_box': (30, 30),
+        'stroke_width': 2,
+        'paths': [
+            # Stem
+            ([(14, 2), (14, 26)], True),
+            # Upper loop, broken open
+            ([(14, 3), (17, 6)], True),
+            # Diagonal from the top right to the bottom left, through the centre
+            ([(25, 3), (3, 25)], True),
+            # Short stroke on the upper left
+            ([(9, 9), (12, 12)], True),
+            # Lower loop
+            ([(14, 14), (19, 19), (19, 20), (14, 25)], True),
+        ],
+    },
+}
+
+
+def encode(icon):
+    """Returns the PDCI bytes for one icon description."""
+    commands = b''
+    for points, is_open in icon['paths']:
+        commands += struct.pack('<BBBBBHH', PATH, 0, WHITE, icon['stroke_width'], CLEAR,
+                                1 if is_open else 0, len(points))
+        for x, y in points:
+            commands += struct.pack('<hh', x, y)
+    width, height = icon['view_box']
+    image = struct.pack('<BBhhH', PDC_VERSION, 0, width, height, len(icon['paths'])) + commands
+    return b'PDCI' + struct.pack('<I', len(image)) + image
+
+
+def write_icon(name, out_path):
+    """Writes the named icon's PDCI resource, returning its size in bytes."""
+    data = encode(ICONS[name])
+    with open(out_path, 'wb') as f:
+        f.write(data)
+    return len(data)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: pdc.py ICON OUT')
+    write_icon(sys.argv[1], sys.argv[2])
@@ -0,0 +1,164 @@
+#
+# Weather condition sprite sheet.
+#
+# The icons are drawn below as ASCII art ('#' is ink, anything else is
+# transparent) and written side by side into one PNG, a transparent and
+# white 1-bit palettized image that the SDK packs as a 1BitPalette bitmap.
+# The order of ICONS is the sprite index src/c/main.c selects with
+# weather_icon_index.
+#
+# The sheet is committed with the other resources. After changing the icons,
+# regenerate it from the repository root:
+#
+#   python tools/sprites.py resources/images/weather_sprites.png
+#
+
+import struct
+import sys
+import zlib
+
+ICON_SIZE = 16
+
+ICONS = [
+    ('clear', [
+        '       #        ',
+        '   #   #   #    ',
+        '    #     #     ',
+        '      ###       ',
+        '     #####      ',
+        '    #######     ',
+        ' ## ####### ##  ',
+        '    #######     ',
+        '     #####      ',
+        '      ###       ',
+        '    #     #     ',
+        '   #   #   #    ',
+        '       #        ',
+        '                ',
+        '                ',
+        '                ',
+    ]),
+    ('clouds', [
+        '                ',
+        '                ',
+        '                ',
+        '      ####      ',
+        '     ######     ',
+        '  ## ####### #  ',
+        ' ############## ',
+        '################',
+        '################',
+        '################',
+        ' ############## ',
+        '                ',
+        '                ',
+        '                ',
+        '                ',
+        '                ',
+    ]),
+    ('rain', [
+        '      ####      ',
+        '     ######     ',
+        '  ## ####### #  ',
+        ' ############## ',
+        '################',
+        '################',
+        ' ############## ',
+        '                ',
+        '  #   #   #   # ',
+        ' #   #   #   #  ',
+        '                ',
+        '   #   #   #    ',
+        '  #   #   #     ',
+        '                ',
+        '                ',
+        '                ',
+    ]),
+    ('snow', [
+        '                ',
+        '       #        ',
+        '    #  #  #     ',
+        '     # # #      ',
+        '      ###       ',
+        '  ###########   ',
+        '      ###       ',
+        '     # # #      ',
+        '    #  #  #     ',
+        '       #        ',
+        '                ',
+        '  #    #     #  ',
+        '                ',
+        '     #     #    ',
+        '                ',
+        '                ',
+    ]),
+    ('thunder', [
+        '      ####      ',
+        '     ######     ',
+        '  ## ####### #  ',
+        ' ############## ',
+        '################',
+        '################',
+        ' ############## ',
+        '       ##       ',
+        '      ##        ',
+        '     ######     ',
+        '       ##       ',
+        '      ##        ',
+        '     ##         ',
+        '                ',
+        '                ',
+        '                ',
+    ]),
+    ('mist', [
+        '                ',
+        '                ',
+        '                ',
+        ' ############   ',
+        '                ',
+        '   ############ ',
+        '                ',
+        ' ############   ',
+        '                ',
+        '   ############ ',
+        '                ',
+        ' ############   ',
+        '                ',
+        '                ',
+        '                ',
+        '                ',
+    ]),
+]
+
+
+def _chunk(kind, data):
+    return (struct.pack('>I', len(data)) + kind + data +
+            struct.pack('>I', zlib.crc32(kind + data) & 0xFFFFFFFF))
+
+
+def write_sheet(out_path):
+    """Writes the sprite sheet PNG, returning its (width, height)."""
+    width, height = ICON_SIZE * len(ICONS), ICON_SIZE
+    raw = b''
+    for y in range(height):
+        row = bytearray((width + 7) // 8)
+        for i, (_, art) in enumerate(ICONS):
+            for x, pixel in enumerate(art[y]):
+                if pixel == '#':
+                    px = i * ICON_SIZE + x
+                    row[px // 8] |= 0x80 >> (px % 8)
+        raw += b'\x00' + bytes(row)
+    with open(out_path, 'wb') as f:
+        f.write(b'\x89PNG\r\n\x1a\n')
+        f.write(_chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 1, 3, 0, 0, 0)))
+        f.write(_chunk(b'PLTE', b'\x00\x00\x00\xff\xff\xff'))
+        f.write(_chunk(b'tRNS', b'\x00'))
+        f.write(_chunk(b'IDAT', zlib.compress(raw, 9)))
+        f.write(_chunk(b'IEND', b''))
+    return width, height
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 2:
+        sys.exit('usage: sprites.py OUT')
+    write_sheet(sys.argv[1])
@@ -0,0 +1,117 @@
+#
+# Worst-case stack depth report for the wscript build.
+#
+# Combines the per-function frame sizes GCC writes with -fstack-usage (.su
+# files) with a call graph read from the linked ELF's disassembly, and walks
+# the graph from each entry point the firmware calls into. Calls through
+# function pointers cannot be seen in the disassembly; they are listed in
+# INDIRECT_CALLS by hand and functions that make unlisted indirect calls are
+# flagged in the report.
+#
+
+import re
+import subprocess
+
+# Handlers the firmware calls into, whose worst-case depth is reported
+ENTRY_POINTS = [
+    'tick_handler',
+    'battery_callback',
+    'bluetooth_callback',
+    'inbox_received_callback',
+    'inbox_dropped_callback',
+    'outbox_failed_callback',
+    'outbox_sent_callback',
+    'battery_update_proc',
+    'static_scene_update_proc',
+    'date_update_proc',
+    'weather_update_proc',
+    'bt_icon_update_proc',
+    'scheduler_timer_fired',
+]
+
+# Calls made through function pointers: caller -> possible callees
+INDIRECT_CALLS = {
+    'inbox_received_callback': ['inbox_read_temperature', 'inbox_read_conditions',
+                                'inbox_read_log_dump', 'inbox_read_theme',
+                                'inbox_read_weather_icon'],
+    'scheduler_run_due': ['bt_icon_release', 'bt_debounce_expired', 'frame_commit',
+                          'startup_stage_resources', 'startup_stage_services'],
+    'frame_commit': ['frame_commit_layers'],
+}
+
+FUNCTION_RE = re.compile(r'^[0-9a-f]+ <([^>]+)>:$')
+CALL_RE = re.compile(r'\t(bl|blx|b\.w|b)\s+[0-9a-f]+ <([^>+]+)>')
+INDIRECT_RE = re.compile(r'\tblx\s+(r\d+|ip|lr)\b')
+
+
+def frame_sizes(su_paths):
+    """Returns {function: stack bytes} from GCC .su files."""
+    sizes = {}
+    for path in su_paths:
+        with open(path) as f:
+            for line in f:
+                parts = line.rstrip('\n').split('\t')
+                if len(parts) >= 2:
+                    name = parts[0].split(':')[-1]
+                    sizes[name] = max(sizes.get(name, 0), int(parts[1]))
+    return sizes
+
+
+def call_graph(disassembly):
+    """Returns ({caller: set(callees)}, set(functions with indirect calls))."""
+    graph = {}
+    indirect = set()
+    current = None
+    for line in disassembly.splitlines():
+        match = FUNCTION_RE.match(line)
+        if match:
+            current = match.group(1)
+            graph.setdefault(current, set())
+            continue
+        if current is None:
+            continue
+        match = CALL_RE.search(line)
+        if match and match.group(2) != current:
+            graph[current].add(match.group(2))
+        elif INDIRECT_RE.search(line):
+            indirect.add(current)
+    for caller, callees in INDIRECT_CALLS.items():
+        graph.setdefault(caller, set()).update(callees)
+    return graph, indirect - set(INDIRECT_CALLS)
+
+
+def worst_depth(name, graph, sizes, path=()):
+    """Returns (bytes, call chain, complete) for the deepest path from name.
+
+    complete is False when the path reaches a function with no frame size
+    (firmware syscalls, libc) or recursion, so the depth is a lower bound.
+    """
+    if name in path:
+        return 0, [name + ' (recursion)'], False
+    own = sizes.get(name)
+    best = (0, [], True)
+    for callee in sorted(graph.get(name, ())):
+        depth = worst_depth(callee, graph, sizes, path + (name,))
+        if depth[0] > best[0] or (depth[0] == best[0] and not depth[2]):
+            best = depth
+    return (own or 0) + best[0], [name] + best[1], best[2] and own is not None
+
+
+def report(cc, elf, su_paths):
+    """Returns the report lines for the linked app."""
+    objdump = re.sub(r'gcc(\.exe)?$', 'objdump', cc)
+    disassembly = subprocess.check_output([objdump, '-d', elf]).decode('utf-8', 'replace')
+    graph, indirect = call_graph(disassembly)
+    sizes = frame_sizes(su_paths)
+
+    lines = []
+    for entry in ENTRY_POINTS:
+        if entry not in graph and entry not in sizes:
+            continue
+        depth, chain, complete = worst_depth(entry, graph, sizes)
+        lines.append('{:<26} {:>5}{} bytes  {}'.format(
+            entry, depth, ' ' if complete else '+', ' > '.join(chain)))
+    if indirect:
+        lines.append('unlisted indirect calls in: ' + ', '.join(sorted(indirect)))
+    lines.append('(+ marks a lower bound: the path reaches firmware or libc code)')
+    return lines
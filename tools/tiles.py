@@ -0,0 +1,100 @@
+#
+# Tiled background assets for the tile renderer.
+#
+# Splits a PNG into square tiles, stores each distinct tile once and writes
+# two raw resources the watch reads directly (little endian):
+#
+#   tiles:    tile size, bits per pixel, tile count (u16), 16 palette colours
+#             (GColor8), then each tile's rows, leftmost pixel in the most
+#             significant bits as in Pebble's palettized bitmaps; 8 bits per
+#             pixel tiles hold GColor8 values and ignore the palette
+#   tile map: width and height in pixels (u16), columns and rows of tiles,
+#             then one tile index per cell, row by row
+#
+# Both are committed with the other resources. After changing the PNG or
+# these scripts, regenerate them from the repository root:
+#
+#   python tools/tiles.py resources/images/background.png 8 resources/data/background_tiles.bin resources/data/background_tilemap.bin
+#
+
+import struct
+import sys
+
+import bitmaps
+
+PALETTE_SIZE = 16
+
+
+def gcolor8(pixel):
+    """Returns the GColor8 value the SDK quantizes an (r, g, b, a) pixel to."""
+    r, g, b, a = pixel
+    if a >> 6 == 0:
+        return 0
+    return (a >> 6) << 6 | (r >> 6) << 4 | (g >> 6) << 2 | b >> 6
+
+
+def split(png_path, tile_size):
+    """Returns (width, height, bits, palette, tiles, tile_map) for the PNG.
+
+    tiles are lists of GColor8 rows; cells past the right and bottom edges
+    are padded with the first colour and are never drawn."""
+    width, height, rows = bitmaps.read_png(png_path)
+    pixels = [[gcolor8(p) for p in row] for row in rows]
+    palette = sorted(set(c for row in pixels for c in row))
+    bits = 8
+    if len(palette) <= PALETTE_SIZE:
+        bits = next(b for b in (1, 2, 4) if len(palette) <= 1 << b)
+
+    columns = (width + tile_size - 1) // tile_size
+    tile_rows = (height + tile_size - 1) // tile_size
+    pad = palette[0]
+    tiles = []
+    index = {}
+    tile_map = []
+    for ty in range(tile_rows):
+        for tx in range(columns):
+            tile = []
+            for y in range(ty * tile_size, (ty + 1) * tile_size):
+                row = pixels[y] if y < height else []
+                tile.append(tuple(row[x] if x < len(row) else pad
+                                  for x in range(tx * tile_size, (tx + 1) * tile_size)))
+            tile = tuple(tile)
+            if tile not in index:
+                index[tile] = len(tiles)
+                tiles.append(tile)
+            tile_map.append(index[tile])
+    if len(tiles) > 256:
+        raise ValueError('{}: {} distinct tiles, the tile map holds at most 256'.format(
+            png_path, len(tiles)))
+    return width, height, bits, palette, tiles, (columns, tile_rows, tile_map)
+
+
+def _pack_row(row, bits, palette):
+    if bits == 8:
+        return bytearray(row)
+    packed = bytearray((len(row) * bits + 7) // 8)
+    per_byte = 8 // bits
+    for x, colour in enumerate(row):
+        packed[x // per_byte] |= palette.index(colour) << (8 - bits * (x % per_byte + 1))
+    return packed
+
+
+def write_tiles(png_path, tile_size, tiles_path, map_path):
+    """Writes the tiles and tile map resources, returning the tile counts."""
+    width, height, bits, palette, tiles, (columns, tile_rows, tile_map) = split(png_path, tile_size)
+    with open(tiles_path, 'wb') as f:
+        f.write(struct.pack('<BBH', tile_size, bits, len(tiles)))
+        f.write(bytes(bytearray((palette + [0] * PALETTE_SIZE)[:PALETTE_SIZE])))
+        for tile in tiles:
+            for row in tile:
+                f.write(bytes(_pack_row(row, bits, palette)))
+    with open(map_path, 'wb') as f:
+        f.write(struct.pack('<HHBB', width, height, columns, tile_rows))
+        f.write(bytes(bytearray(tile_map)))
+    return len(tiles), len(tile_map)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 5:
+        sys.exit('usage: tiles.py PNG TILE_SIZE TILES_OUT MAP_OUT')
+    write_tiles(sys.argv[1], int(sys.argv[2]), sys.argv[3], sys.argv[4])